@@ -0,0 +1,68 @@
+// proc_rss.h - Resident memory of a process tree from /proc (Linux only)
+#pragma once
+
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace bench {
+
+// Resident set size of one process in kB (0 if it is gone)
+inline long rssKb(int pid) {
+    std::ifstream status("/proc/" + std::to_string(pid) + "/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0) {
+            return std::strtol(line.c_str() + 6, nullptr, 10);
+        }
+    }
+    return 0;
+}
+
+// Parent pid from /proc/<pid>/stat (the command name may contain spaces)
+inline int parentPid(int pid) {
+    std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+    std::string content((std::istreambuf_iterator<char>(stat)), std::istreambuf_iterator<char>());
+    auto close = content.rfind(')');
+    if (close == std::string::npos) return -1;
+    std::istringstream rest(content.substr(close + 2));
+    char state;
+    int ppid = -1;
+    rest >> state >> ppid;
+    return ppid;
+}
+
+// This process and all descendants
+inline std::vector<int> processTree(int root) {
+    std::unordered_map<int, std::vector<int>> children;
+    if (DIR* proc = opendir("/proc")) {
+        while (dirent* entry = readdir(proc)) {
+            int pid = std::atoi(entry->d_name);
+            if (pid > 0) children[parentPid(pid)].push_back(pid);
+        }
+        closedir(proc);
+    }
+
+    std::vector<int> tree{root};
+    for (size_t i = 0; i < tree.size(); ++i) {
+        for (int child : children[tree[i]]) tree.push_back(child);
+    }
+    return tree;
+}
+
+// RSS of this process and its descendants (the WebKit web/network processes)
+inline long treeRssKb(size_t* processes) {
+    auto tree = processTree(getpid());
+    long total = 0;
+    for (int pid : tree) total += rssKb(pid);
+    if (processes) *processes = tree.size();
+    return total;
+}
+
+} // namespace bench
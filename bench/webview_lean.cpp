@@ -0,0 +1,140 @@
+// webview_lean.cpp - Startup time and resident memory, default vs lean profile
+//
+// Creates N webviews with a small UI page and records, per view, how long
+// create() takes and how long until the page has loaded. Then sums the RSS of
+// this process and all its descendants (the WebKit web/network processes).
+//
+// Usage: clasp-gui-bench-lean [--count N] [--seconds S] [--profile default|lean]
+//                             [--software] [--heap MB]
+// Without --profile, runs itself once per profile and prints both results.
+// --software and --heap apply to both profiles. Linux only (reads /proc).
+
+#include <clasp-gui/webview.h>
+#include "choc/gui/choc_MessageLoop.h"
+#include "proc_rss.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* kPage =
+    "<!DOCTYPE html><html><body style='background:#1e1e1e'>"
+    "<div id='root'></div><script>"
+    "var root = document.getElementById('root');"
+    "for (var i = 0; i < 200; i++) {"
+    "  var d = document.createElement('div');"
+    "  d.textContent = 'param ' + i; root.appendChild(d);"
+    "}"
+    "window.addEventListener('load', function() { window.__bench_loaded(); });"
+    "</script></body></html>";
+
+double msSince(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+double mean(const std::vector<double>& values) {
+    double sum = 0;
+    for (double v : values) sum += v;
+    return values.empty() ? 0 : sum / values.size();
+}
+
+int runProfile(const std::string& profile, int count, int seconds,
+               bool software, int heapMb) {
+    choc::messageloop::initialise();
+    long baseline = bench::treeRssKb(nullptr);
+
+    clasp_gui::WebViewOptions options;
+    options.leanProfile = (profile == "lean");
+    options.compositing = software ? clasp_gui::CompositingPolicy::Never
+                                   : clasp_gui::CompositingPolicy::Default;
+    options.jsHeapLimitMb = heapMb;
+    options.processWideSettings = true;  // Each profile runs in its own process
+
+    std::vector<std::unique_ptr<clasp_gui::WebView>> views;
+    std::vector<Clock::time_point> started(count);
+    std::vector<double> createMs;
+    std::vector<double> loadMs;
+
+    for (int i = 0; i < count; ++i) {
+        started[i] = Clock::now();
+        auto view = std::make_unique<clasp_gui::WebView>(options);
+        if (!view->create()) {
+            std::fprintf(stderr, "webview creation failed\n");
+            return 1;
+        }
+        createMs.push_back(msSince(started[i], Clock::now()));
+
+        view->bind("__bench_loaded", [&, i](const std::string&) {
+            loadMs.push_back(msSince(started[i], Clock::now()));
+            return std::string();
+        });
+        view->loadHtml(kPage);
+        views.push_back(std::move(view));
+    }
+
+    choc::messageloop::Timer stopTimer(static_cast<uint32_t>(seconds * 1000), [] {
+        choc::messageloop::stop();
+        return false;
+    });
+    choc::messageloop::run();
+
+    if (static_cast<int>(loadMs.size()) < count) {
+        std::fprintf(stderr, "%s: only %zu of %d pages loaded in %d s\n", profile.c_str(),
+                     loadMs.size(), count, seconds);
+    }
+
+    size_t processes = 0;
+    long total = bench::treeRssKb(&processes);
+    std::sort(loadMs.begin(), loadMs.end());
+    double firstLoad = loadMs.empty() ? 0 : loadMs.front();
+    std::printf("%-8s %6d %10zu %11.1f %11.1f %11.1f %12.1f %14.1f\n", profile.c_str(), count,
+                processes, mean(createMs), firstLoad, mean(loadMs), total / 1024.0,
+                (total - baseline) / 1024.0 / count);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int count = 10;
+    int seconds = 5;
+    int heapMb = 0;
+    bool software = false;
+    std::string profile;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--software") { software = true; continue; }
+        if (i + 1 >= argc) break;
+        if (arg == "--count") count = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--seconds") seconds = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--heap") heapMb = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--profile") profile = argv[++i];
+    }
+
+    if (!profile.empty()) {
+        return runProfile(profile, count, seconds, software, heapMb);
+    }
+
+    // Web context settings are process-wide, so each profile runs in its own process
+    std::printf("%-8s %6s %10s %11s %11s %11s %12s %14s\n", "profile", "views", "processes",
+                "create (ms)", "first (ms)", "load (ms)", "total (MB)", "per view (MB)");
+    std::fflush(stdout);
+    for (const char* p : {"default", "lean"}) {
+        std::string cmd = std::string(argv[0]) + " --profile " + p +
+                          " --count " + std::to_string(count) +
+                          " --seconds " + std::to_string(seconds) +
+                          " --heap " + std::to_string(heapMb) +
+                          (software ? " --software" : "");
+        if (std::system(cmd.c_str()) != 0) return 1;
+    }
+    return 0;
+}
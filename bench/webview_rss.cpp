@@ -0,0 +1,104 @@
+// webview_rss.cpp - Resident memory per WebView, shared vs isolated web processes
+//
+// Creates N webviews with a small UI page, lets them load, then sums the RSS
+// of this process and all its descendants (the WebKit web/network processes).
+//
+// Usage: clasp-gui-bench-rss [--count N] [--seconds S] [--mode shared|isolated]
+// Without --mode, runs itself once per mode and prints both results.
+// Linux only (reads /proc). WebKitGTK 2.26+ ignores shareWebProcess, so there
+// the shared row is labelled as a no-op.
+
+#include <clasp-gui/webview.h>
+#include "choc/gui/choc_MessageLoop.h"
+#include "proc_rss.h"
+
+#include <webkit2/webkit2.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* kPage =
+    "<!DOCTYPE html><html><body style='background:#1e1e1e'>"
+    "<div id='root'></div><script>"
+    "var root = document.getElementById('root');"
+    "for (var i = 0; i < 200; i++) {"
+    "  var d = document.createElement('div');"
+    "  d.textContent = 'param ' + i; root.appendChild(d);"
+    "}"
+    "</script></body></html>";
+
+// Whether the running WebKitGTK honours shareWebProcess
+bool sharingSupported() {
+    return webkit_get_major_version() == 2 && webkit_get_minor_version() < 26;
+}
+
+int runMode(const std::string& mode, int count, int seconds) {
+    choc::messageloop::initialise();
+    long baseline = bench::treeRssKb(nullptr);
+
+    clasp_gui::WebViewOptions options;
+    options.shareWebProcess = (mode == "shared");
+    options.processWideSettings = true;  // Each mode runs in its own process
+
+    std::vector<std::unique_ptr<clasp_gui::WebView>> views;
+    for (int i = 0; i < count; ++i) {
+        auto view = std::make_unique<clasp_gui::WebView>(options);
+        if (!view->create()) {
+            std::fprintf(stderr, "webview creation failed\n");
+            return 1;
+        }
+        view->loadHtml(kPage);
+        views.push_back(std::move(view));
+    }
+
+    choc::messageloop::Timer stopTimer(static_cast<uint32_t>(seconds * 1000), [] {
+        choc::messageloop::stop();
+        return false;
+    });
+    choc::messageloop::run();
+
+    size_t processes = 0;
+    long total = bench::treeRssKb(&processes);
+    std::string label = mode;
+    if (mode == "shared" && !sharingSupported()) label += " (no-op)";
+    std::printf("%-15s %6d %10zu %12.1f %14.1f\n", label.c_str(), count, processes,
+                total / 1024.0, (total - baseline) / 1024.0 / count);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int count = 10;
+    int seconds = 5;
+    std::string mode;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--count") count = std::max(1, std::atoi(argv[i + 1]));
+        else if (arg == "--seconds") seconds = std::max(1, std::atoi(argv[i + 1]));
+        else if (arg == "--mode") mode = argv[i + 1];
+    }
+
+    if (!mode.empty()) {
+        return runMode(mode, count, seconds);
+    }
+
+    // Web context settings are process-wide, so each mode runs in its own process
+    std::printf("%-15s %6s %10s %12s %14s\n", "mode", "views", "processes", "total (MB)",
+                "per view (MB)");
+    std::fflush(stdout);
+    for (const char* m : {"isolated", "shared"}) {
+        std::string cmd = std::string(argv[0]) + " --mode " + m +
+                          " --count " + std::to_string(count) +
+                          " --seconds " + std::to_string(seconds);
+        if (std::system(cmd.c_str()) != 0) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,202 @@
+// x11_resize.cpp - Cost of an interactive host resize in the X11 platform layer
+//
+// Drags a child window through a series of sizes, several steps per 60 Hz
+// frame like a host forwarding every pointer motion, and compares:
+//   reconnect  a new X connection per step (the old platform code)
+//   direct     one connection, every step sent to the server
+//   setSize    a real WebView embedded in the parent: WebView::setSize() per
+//              step, platform::flushPendingResizes() once per frame
+// Prints the time spent in resize calls per step and how many ConfigureNotify
+// events the server generated for the child, and whether this build
+// coalesces resizes at all.
+//
+// Usage: xvfb-run ./clasp-gui-bench-resize [--frames N] [--steps S]
+// Linux only; needs an X server (Xvfb is enough).
+
+#include <clasp-gui/platform.h>
+#include <clasp-gui/webview.h>
+#include "choc/gui/choc_MessageLoop.h"
+
+#include <X11/Xlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr auto kFrame = std::chrono::microseconds(16667);
+
+struct Result {
+    bool ok = true;
+    double callUs = 0;  // Total time in resize calls
+    int configures = 0;
+};
+
+// Size of step i of a drag from 400x300 growing diagonally
+void stepSize(int i, int& width, int& height) {
+    width = 400 + (i % 400);
+    height = 300 + (i % 300);
+}
+
+int countConfigures(Display* display, Window window) {
+    // Give the other connection's requests time to reach the server
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    XSync(display, False);
+
+    int count = 0;
+    XEvent event;
+    while (XCheckTypedWindowEvent(display, window, ConfigureNotify, &event)) {
+        ++count;
+    }
+    return count;
+}
+
+// Plain X child window, resized through Xlib directly
+Result runXlib(const std::string& mode, Display* display, Window parent, int frames, int steps) {
+    Window child = XCreateSimpleWindow(display, parent, 0, 0, 400, 300, 0, 0, 0x1e1e1e);
+    XMapWindow(display, child);
+    XSelectInput(display, child, StructureNotifyMask);
+    XSync(display, False);
+
+    Result result;
+    auto frameStart = Clock::now();
+    int step = 0;
+
+    for (int f = 0; f < frames; ++f) {
+        auto start = Clock::now();
+        for (int s = 0; s < steps; ++s, ++step) {
+            int width, height;
+            stepSize(step, width, height);
+
+            if (mode == "reconnect") {
+                Display* own = XOpenDisplay(NULL);
+                if (!own) continue;
+                XMoveResizeWindow(own, child, 0, 0, width, height);
+                XFlush(own);
+                XCloseDisplay(own);
+            } else {
+                XMoveResizeWindow(display, child, 0, 0, width, height);
+                XFlush(display);
+            }
+        }
+        result.callUs += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+        frameStart += kFrame;
+        std::this_thread::sleep_until(frameStart);
+    }
+
+    result.configures = countConfigures(display, child);
+    XDestroyWindow(display, child);
+    XSync(display, False);
+    return result;
+}
+
+// Real WebView in the parent, driven like GuiHelper: setSize() per host
+// resize and flushPendingResizes() from the idle timer, on the main loop
+Result runSetSize(Display* display, Window parent, int frames, int steps) {
+    Result result;
+    clasp_gui::WebView view;
+    clasp_gui::NativeWindow native;
+    native.api = clasp_gui::WindowApi::X11;
+    native.handle = reinterpret_cast<void*>(static_cast<uintptr_t>(parent));
+    if (!view.create() || !view.setParent(native) || !view.setSize(400, 300)) {
+        result.ok = false;
+        return result;
+    }
+
+    // The embedded view is the parent's only child
+    XSync(display, False);
+    Window root, owner, child = 0;
+    Window* children = nullptr;
+    unsigned int count = 0;
+    if (XQueryTree(display, parent, &root, &owner, &children, &count) && count > 0) {
+        child = children[count - 1];
+    }
+    if (children) XFree(children);
+    if (!child) {
+        result.ok = false;
+        return result;
+    }
+    XSelectInput(display, child, StructureNotifyMask);
+    XSync(display, False);
+
+    int frame = 0;
+    int step = 0;
+    choc::messageloop::Timer frameTimer(16, [&] {
+        auto start = Clock::now();
+        for (int s = 0; s < steps; ++s, ++step) {
+            int width, height;
+            stepSize(step, width, height);
+            view.setSize(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+        }
+        clasp_gui::platform::flushPendingResizes();  // GuiHelper::idle()
+        result.callUs += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+        if (++frame < frames) return true;
+        choc::messageloop::stop();
+        return false;
+    });
+    choc::messageloop::run();
+
+    result.configures = countConfigures(display, child);
+    view.destroy();
+    XSync(display, False);
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int frames = 120;
+    int steps = 8;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--frames") frames = std::max(1, std::atoi(argv[i + 1]));
+        else if (arg == "--steps") steps = std::max(1, std::atoi(argv[i + 1]));
+    }
+
+    choc::messageloop::initialise();
+
+    Display* display = XOpenDisplay(NULL);
+    if (!display) {
+        std::fprintf(stderr, "no X display (run under xvfb-run)\n");
+        return 1;
+    }
+
+    Window parent = XCreateSimpleWindow(display, DefaultRootWindow(display), 0, 0, 800, 600,
+                                        0, 0, 0);
+    XMapWindow(display, parent);
+    XSync(display, False);
+
+    if (!clasp_gui::platform::coalescesResizes()) {
+        std::printf("resize coalescing is not available in this build: "
+                    "setSize applies every step at once\n");
+    }
+
+    int total = frames * steps;
+    std::printf("%-10s %7s %12s %12s\n", "mode", "steps", "per step (us)", "configures");
+    for (const char* mode : {"reconnect", "direct"}) {
+        Result r = runXlib(mode, display, parent, frames, steps);
+        std::printf("%-10s %7d %12.1f %12d\n", mode, total, r.callUs / total, r.configures);
+    }
+
+    Result r = runSetSize(display, parent, frames, steps);
+    if (r.ok) {
+        std::printf("%-10s %7d %12.1f %12d\n", "setSize", total, r.callUs / total, r.configures);
+    } else {
+        std::printf("%-10s %7d %12s %12s  (webview could not be embedded)\n", "setSize", total,
+                    "-", "-");
+    }
+
+    XDestroyWindow(display, parent);
+    XCloseDisplay(display);
+    return 0;
+}
@@ -0,0 +1,37 @@
+# clasp_gui_add_ui_bundle(<target> <dir> [NAME <name>])
+#
+# Packs the web UI in <dir> into a source file compiled into <target>. The
+# bundle is reached through the generated header <name>.h (default: uiBundle):
+#
+#   #include "uiBundle.h"
+#   options.resourceProvider = uiBundle().provider();
+#
+# Files are re-packed whenever one of them changes (re-run CMake after
+# adding or removing files). Works in the clasp-gui build tree and after
+# find_package(clasp-gui), through the namespaced targets.
+function(clasp_gui_add_ui_bundle target dir)
+    cmake_parse_arguments(ARG "" "NAME" "" ${ARGN})
+    if(NOT ARG_NAME)
+        set(ARG_NAME uiBundle)
+    endif()
+
+    get_filename_component(dir "${dir}" ABSOLUTE)
+    file(GLOB_RECURSE files CONFIGURE_DEPENDS "${dir}/*")
+
+    set(out_dir "${CMAKE_CURRENT_BINARY_DIR}/clasp_ui_bundle/${target}")
+    set(out_cpp "${out_dir}/${ARG_NAME}.cpp")
+    set(out_h "${out_dir}/${ARG_NAME}.h")
+
+    add_custom_command(
+        OUTPUT "${out_cpp}" "${out_h}"
+        COMMAND ${CMAKE_COMMAND} -E make_directory "${out_dir}"
+        COMMAND clasp-gui::clasp-gui-pack ${ARG_NAME} "${dir}" "${out_cpp}" "${out_h}"
+        DEPENDS clasp-gui::clasp-gui-pack ${files}
+        COMMENT "Packing UI bundle ${ARG_NAME} from ${dir}"
+        VERBATIM
+    )
+
+    target_sources(${target} PRIVATE "${out_cpp}" "${out_h}")
+    target_include_directories(${target} PRIVATE "${out_dir}")
+    target_link_libraries(${target} PRIVATE clasp-gui::clasp-gui)
+endfunction()
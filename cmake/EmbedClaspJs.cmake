@@ -0,0 +1,32 @@
+# Embeds js/clasp.js into the library as a C++ byte array
+# cmake -DINPUT=<clasp.js> -DOUTPUT=<out.cpp> -P EmbedClaspJs.cmake
+#
+# Comments, indentation and blank lines are stripped. The stripping is
+# line-based and safe for clasp.js, which keeps its comments on lines of
+# their own.
+
+file(READ "${INPUT}" js)
+
+# Block comments, full-line // comments, indentation, blank lines
+string(REGEX REPLACE "/\\*[^*]*\\*+([^/*][^*]*\\*+)*/" "" js "${js}")
+string(REGEX REPLACE "\n[ \t]*//[^\n]*" "\n" js "${js}")
+string(REGEX REPLACE "\n[ \t]+" "\n" js "${js}")
+string(REGEX REPLACE "[ \t]+\n" "\n" js "${js}")
+string(REGEX REPLACE "\n\n+" "\n" js "${js}")
+string(STRIP "${js}" js)
+
+file(WRITE "${OUTPUT}.js" "${js}\n")
+file(READ "${OUTPUT}.js" hex HEX)
+string(LENGTH "${hex}" hexLength)
+math(EXPR size "${hexLength} / 2")
+string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${hex}")
+string(REGEX REPLACE "(0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,)" "\\1\n" bytes "${bytes}")
+
+file(WRITE "${OUTPUT}.tmp"
+"// Generated from clasp.js by EmbedClaspJs.cmake - do not edit\n"
+"extern const unsigned char clasp_gui_embedded_clasp_js[] = {\n${bytes}0x00\n};\n"
+"extern const unsigned long clasp_gui_embedded_clasp_js_size = ${size};\n")
+
+# Only touch the output when it changed, to avoid needless rebuilds
+execute_process(COMMAND ${CMAKE_COMMAND} -E copy_if_different "${OUTPUT}.tmp" "${OUTPUT}")
+file(REMOVE "${OUTPUT}.tmp")
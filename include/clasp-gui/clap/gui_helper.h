@@ -1,8 +1,12 @@
 #pragma once
 
 #include "../webview.h"
+#include "../webview_pool.h"
 #include <clap/clap.h>
 
+#include <functional>
+#include <memory>
+
 namespace clasp_gui {
 namespace clap {
 
@@ -17,6 +21,40 @@ public:
     void setWebView(WebView* webview);
     WebView* getWebView() const { return webview_; }
 
+    // Lease the webview from a pool on create() and return it on destroy(),
+    // instead of using the one passed to setWebView()
+    void setWebViewPool(WebViewPool* pool);
+
+    // Called once create() has a webview (e.g., to construct clasp::Protocol),
+    // and in destroy() before the webview is given up
+    using WebViewCallback = std::function<void(WebView&)>;
+    void onWebViewCreated(WebViewCallback callback);
+    void onWebViewDestroy(WebViewCallback callback);
+
+    // Park instead of destroy: destroy() detaches the webview but keeps the
+    // page alive, and the next create() reuses it. Parked views count against
+    // the pool's memory budget (the shared pool if none was set) and may be
+    // evicted, which runs the destroy callback then.
+    void setParkOnDestroy(bool park);
+    bool isParked() const { return parked_; }
+
+    // Called when the webview is parked/reused, e.g. to pause/resume clasp::Protocol
+    void onWebViewParked(WebViewCallback callback);
+    void onWebViewResumed(WebViewCallback callback);
+
+    // Lazy creation: create() returns at once and setParent() shows a native
+    // placeholder. The webview is built on the first show() or idle(), and
+    // swapped in once the page has loaded (clasp.js calls pageReady()).
+    void setLazyCreate(bool lazy);
+
+    // Build a pending lazy webview now and apply coalesced resizes; call from
+    // a main-thread idle slot or timer
+    void idle();
+
+    // Swap the placeholder for the loaded page; clasp.js triggers this on load,
+    // call it yourself if the page does not use clasp.js
+    void pageReady();
+
     // CLAP gui extension implementation
     bool isApiSupported(const char* api, bool isFloating) const;
     bool getPreferredApi(const char** api, bool* isFloating) const;
@@ -45,6 +83,24 @@ public:
 
 private:
     WebView* webview_ = nullptr;
+    WebViewPool* pool_ = nullptr;
+    std::unique_ptr<WebView> lease_;
+    WebViewCallback onCreated_;
+    WebViewCallback onDestroy_;
+    WebViewCallback onParked_;
+    WebViewCallback onResumed_;
+    bool parkOnDestroy_ = false;
+    bool parked_ = false;
+    bool lazy_ = false;
+    bool pending_ = false;         // create() called, webview not built yet
+    bool waitingForPage_ = false;  // Built, placeholder still shown
+    NativeWindow parent_;
+    void* placeholder_ = nullptr;
+
+    WebViewPool& parkingPool() const;
+    bool buildWebView();
+    void releaseWebView(bool discard = false);  // discard: destroy a leased view
+    void removePlaceholder();
     uint32_t width_ = 800;
     uint32_t height_ = 600;
     uint32_t minWidth_ = 200;
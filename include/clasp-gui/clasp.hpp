@@ -24,8 +24,14 @@
 
 #include "webview.h"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <functional>
 #include <mutex>
 #include <sstream>
@@ -43,17 +49,148 @@
 
 namespace clasp {
 
+/**
+ * Fixed-capacity single-producer/single-consumer queue
+ * Lock-free and allocation-free after construction
+ */
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Producer side - returns false if the queue is full
+    bool push(const T& item) {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == Capacity) return false;
+        items_[tail & (Capacity - 1)] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side - returns false if the queue is empty
+    bool pop(T& item) {
+        auto head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) return false;
+        item = items_[head & (Capacity - 1)];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::array<T, Capacity> items_{};
+    std::atomic<size_t> head_{0};
+    std::atomic<size_t> tail_{0};
+};
+
+/**
+ * Latest-value handoff between one producer and one consumer
+ * Three preallocated slots: the producer owns the back slot, the consumer owns
+ * the front slot, and the third is swapped through an atomic (index + fresh flag),
+ * so neither side ever waits. Lock-free and allocation-free.
+ */
+template <typename T>
+class TripleBuffer {
+public:
+    // Producer side: fill back(), then publish()
+    T& back() { return slots_[back_]; }
+
+    void publish() {
+        int prev = shared_.exchange(back_ | FRESH, std::memory_order_acq_rel);
+        back_ = prev & INDEX_MASK;
+    }
+
+    // Consumer side: returns true if a newer value was published since the last fetch
+    bool fetch() {
+        if (!(shared_.load(std::memory_order_relaxed) & FRESH)) return false;
+        int prev = shared_.exchange(front_, std::memory_order_acq_rel);
+        front_ = prev & INDEX_MASK;
+        return true;
+    }
+
+    const T& front() const { return slots_[front_]; }
+
+    // Set every slot (e.g. to preallocate) and drop any unfetched value
+    // Not thread-safe: only while neither side is running
+    void reset(const T& value) {
+        slots_.fill(value);
+        shared_.store(shared_.load(std::memory_order_relaxed) & INDEX_MASK,
+                      std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr int INDEX_MASK = 0x3;
+    static constexpr int FRESH = 0x4;
+
+    std::array<T, 3> slots_{};
+    int back_ = 0;
+    int front_ = 1;
+    std::atomic<int> shared_{2};
+};
+
+/**
+ * Host transport state, for playhead and tempo-synced displays
+ */
+struct TransportState {
+    double tempo = 120.0;        // BPM
+    int timeSigNumerator = 4;
+    int timeSigDenominator = 4;
+    bool playing = false;
+    double beatPosition = 0.0;   // Song position in beats (quarter notes)
+};
+
+/**
+ * A parameter edit coming from the UI, for the audio thread
+ */
+struct ParamChange {
+    enum class Type : uint8_t {
+        Value,         // Set param to value
+        GestureBegin,  // UI started editing param
+        GestureEnd     // UI finished editing param
+    };
+
+    Type type = Type::Value;
+    uint32_t id = 0;  // CLAP param id
+    float value = 0.0f;
+};
+
+/**
+ * Options for Protocol::onCall()
+ * A cacheable function must be pure: JS memoizes its results keyed by the
+ * argument list until C++ invalidates them.
+ */
+struct CallOptions {
+    bool cacheable = false;
+    std::vector<std::string> tags;  // Groups for Protocol::invalidateCacheTag()
+};
+
 /**
  * Protocol handler for clasp.js communication
  */
 class Protocol {
 public:
     using CallHandler = std::function<std::string(const std::string& argsJson)>;
+    using MessageHandler = std::function<void(const std::string& payloadJson)>;
+    using MessageBatchHandler = std::function<void(const std::vector<std::string>& payloadsJson)>;
+
+    // Version of the message format; clasp.js must report the same
+    static constexpr int PROTOCOL_VERSION = 1;
 
-    explicit Protocol(clasp_gui::WebView* webview)
-        : webview_(webview) {
-        lastParamUpdate_.fill(std::chrono::steady_clock::time_point{});
+    /**
+     * Attach to a webview
+     * Unless injectClaspJs is false, the library's embedded clasp.js is added
+     * as an init script, so the page needs no <script src="clasp.js"> and the
+     * bridge exists before its first script runs. Construct before navigate().
+     */
+    explicit Protocol(clasp_gui::WebView* webview, bool injectClaspJs = true)
+        : webview_(webview),
+          lastParamUpdate_(DEFAULT_PARAM_SLOTS),
+          gestureState_(DEFAULT_PARAM_SLOTS) {
+        resizeParamSnapshot(DEFAULT_PARAM_SLOTS);
         setupBinding();
+        if (webview_ && injectClaspJs) {
+            webview_->injectClaspJs();
+        }
+        requestHello();
     }
 
     ~Protocol() = default;
@@ -69,20 +206,122 @@ public:
     void onCall(const std::string& name, CallHandler handler) {
         std::lock_guard<std::mutex> lock(handlersMutex_);
         callHandlers_[name] = std::move(handler);
+        cacheableCalls_.erase(name);
+    }
+
+    /**
+     * Register a function with options, e.g. a cacheable lookup:
+     *   proto.onCall("getPresetList", handler, {true, {"presets"}});
+     */
+    void onCall(const std::string& name, CallHandler handler, const CallOptions& options) {
+        std::lock_guard<std::mutex> lock(handlersMutex_);
+        callHandlers_[name] = std::move(handler);
+        if (options.cacheable) {
+            cacheableCalls_[name] = options.tags;
+        } else {
+            cacheableCalls_.erase(name);
+        }
+    }
+
+    /**
+     * Drop memoized JS results of a cacheable function
+     * Must be called on UI/main thread
+     */
+    void invalidateCache(const std::string& name) {
+        sendInvalidate({name});
+    }
+
+    /**
+     * Drop memoized JS results of every cacheable function with this tag
+     * Must be called on UI/main thread
+     */
+    void invalidateCacheTag(const std::string& tag) {
+        std::vector<std::string> names;
+        {
+            std::lock_guard<std::mutex> lock(handlersMutex_);
+            for (const auto& entry : cacheableCalls_) {
+                if (std::find(entry.second.begin(), entry.second.end(), tag) != entry.second.end()) {
+                    names.push_back(entry.first);
+                }
+            }
+        }
+        if (!names.empty()) sendInvalidate(names);
+    }
+
+    /**
+     * Drop all memoized JS call results
+     * Must be called on UI/main thread
+     */
+    void invalidateAllCaches() {
+        sendToJs("invalidate", "{\"all\":true}");
+    }
+
+    /**
+     * Register a handler for fire-and-forget messages from clasp.send()
+     * Handler receives the JSON payload; no reply is sent
+     */
+    void onMessage(const std::string& type, MessageHandler handler) {
+        std::lock_guard<std::mutex> lock(handlersMutex_);
+        messageHandlers_[type] = std::move(handler);
+    }
+
+    /**
+     * Register a batched handler for clasp.send() messages
+     * All messages of this type from one batch (frame) are delivered at once
+     */
+    void onMessageBatch(const std::string& type, MessageBatchHandler handler) {
+        std::lock_guard<std::mutex> lock(handlersMutex_);
+        messageBatchHandlers_[type] = std::move(handler);
+    }
+
+    /**
+     * Register the plugin's parameter ids (clap_param_info.id, in index order)
+     * Gesture tracking and throttling keep one slot per registered id, and
+     * publishParamSnapshot() takes values in this order. Without this, only
+     * ids 0..DEFAULT_PARAM_SLOTS-1 are tracked.
+     * Call on the main thread before the audio thread uses the Protocol
+     * (e.g. in init()); not thread-safe.
+     */
+    void setParamIds(const std::vector<uint32_t>& ids) {
+        paramIds_ = ids;
+        paramLookup_.clear();
+        for (size_t i = 0; i < ids.size(); ++i) {
+            paramLookup_.push_back({ids[i], static_cast<int>(i)});
+        }
+        std::sort(paramLookup_.begin(), paramLookup_.end());
+
+        size_t slots = ids.empty() ? DEFAULT_PARAM_SLOTS : ids.size();
+        lastParamUpdate_.assign(slots, std::chrono::steady_clock::time_point{});
+        gestureState_ = std::vector<std::atomic<uint64_t>>(slots);
+        resizeParamSnapshot(slots);
     }
 
     /**
      * Send a single parameter update to JS
      * Thread-safe - can be called from audio thread
      */
-    void queueParamChange(int paramId, float value) {
-        // Throttle updates per parameter
-        if (paramId >= 0 && paramId < MAX_PARAMS) {
+    void queueParamChange(uint32_t paramId, float value) {
+        int slot = paramSlot(paramId);
+        if (slot >= 0) {
+            // Suppress echoes while the UI is editing this param;
+            // the latest value is sent once when the gesture ends. If the
+            // gesture ends meanwhile the CAS fails and the value goes out now.
+            auto& state = gestureState_[slot];
+            uint64_t current = state.load(std::memory_order_acquire);
+            while (current & GESTURE_ACTIVE) {
+                if (state.compare_exchange_weak(current, packGestureValue(value),
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_acquire)) {
+                    return;
+                }
+            }
+
+            // Throttle updates per parameter
             auto now = std::chrono::steady_clock::now();
-            if (now - lastParamUpdate_[paramId] < updateInterval_) {
+            if (now - lastParamUpdate_[slot] < updateInterval_) {
                 return;
             }
-            lastParamUpdate_[paramId] = now;
+            lastParamUpdate_[slot] = now;
         }
 
         std::lock_guard<std::mutex> lock(queueMutex_);
@@ -98,6 +337,101 @@ public:
         pendingBulkParams_.insert(pendingBulkParams_.end(), params.begin(), params.end());
     }
 
+    /**
+     * Publish a full parameter snapshot (e.g., after a preset load in process())
+     * Real-time safe - no locks or allocation, can be called from audio thread
+     * values[i] is the value of the i-th id passed to setParamIds() (of param
+     * id i if none were registered); extra values are ignored
+     */
+    void publishParamSnapshot(const float* values, int count) {
+        if (!values || count <= 0) return;
+
+        // Fill the back buffer, then flip it with the shared slot
+        auto& back = paramSnapshot_.back();
+        count = std::min(count, static_cast<int>(back.values.size()));
+        std::copy(values, values + count, back.values.begin());
+        back.count = count;
+        paramSnapshot_.publish();
+    }
+
+    /**
+     * Publish the host transport state (call every process() block)
+     * Real-time safe - no locks or allocation, can be called from audio thread
+     * processQueue() only sends it to JS when it changes or the position drifts
+     * from what JS extrapolates
+     */
+    void updateTransport(const TransportState& state) {
+        auto& back = transport_.back();
+        back.state = state;
+        back.time = std::chrono::steady_clock::now();
+        transport_.publish();
+    }
+
+    /**
+     * Set how far (in beats) the real position may drift from the
+     * JS-extrapolated one before a new anchor is sent (default: 0.05)
+     */
+    void setTransportDriftThreshold(double beats) {
+        transportDriftBeats_ = beats;
+    }
+
+    /**
+     * Mark a parameter as being edited by the UI (e.g., knob drag)
+     * While active, queueParamChange() echoes for this param are suppressed
+     * Called automatically for clasp.beginGesture() / clasp.startDrag(..., paramId)
+     * Ids without a slot (see setParamIds()) are not tracked
+     */
+    void beginGesture(uint32_t paramId) {
+        int slot = paramSlot(paramId);
+        if (slot < 0) return;
+        gestureState_[slot].store(GESTURE_ACTIVE, std::memory_order_release);
+    }
+
+    /**
+     * End a UI gesture and queue the authoritative value, if one was suppressed
+     */
+    void endGesture(uint32_t paramId) {
+        int slot = paramSlot(paramId);
+        if (slot < 0) return;
+        // Clearing the flag and taking the suppressed value is one step, so a
+        // value suppressed by the audio thread is either taken here or not
+        // suppressed at all
+        uint64_t previous = gestureState_[slot].exchange(0, std::memory_order_acq_rel);
+        if (previous & GESTURE_PENDING) {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            pendingParams_.push_back({paramId, unpackGestureValue(previous)});
+        }
+    }
+
+    /**
+     * Check whether the UI is currently editing a parameter
+     */
+    bool isGestureActive(uint32_t paramId) const {
+        int slot = paramSlot(paramId);
+        if (slot < 0) return false;
+        return (gestureState_[slot].load(std::memory_order_acquire) & GESTURE_ACTIVE) != 0;
+    }
+
+    /**
+     * Pop the next parameter edit from the UI (clasp.setParam / setParams / gestures)
+     * Real-time safe - call from the audio thread in process() or flush()
+     */
+    bool popParamChange(ParamChange& change) {
+        return uiParamQueue_.pop(change);
+    }
+
+    /**
+     * Drain all pending parameter edits from the UI
+     * fn is called as fn(const ParamChange&); real-time safe if fn is
+     */
+    template <typename Fn>
+    void drainParamChanges(Fn&& fn) {
+        ParamChange change;
+        while (uiParamQueue_.pop(change)) {
+            fn(change);
+        }
+    }
+
     /**
      * Queue a MIDI note on event
      * Thread-safe
@@ -149,20 +483,53 @@ public:
             pendingCCs_.clear();
         }
 
+        // Pick up the latest published snapshot, if any
+        const ParamSnapshot* snapshot = nullptr;
+        if (paramSnapshot_.fetch()) {
+            snapshot = &paramSnapshot_.front();
+        }
+
+        if (paused_) {
+            // Keep only the latest value per param for resume()
+            // (same precedence as the messages below)
+            for (const auto& p : params) pausedParams_[p.id] = p.value;
+            if (snapshot) {
+                for (int i = 0; i < snapshot->count; ++i) {
+                    pausedParams_[snapshotParamId(i)] = snapshot->values[i];
+                }
+            }
+            for (const auto& p : bulkParams) pausedParams_[p.first] = p.second;
+            transport_.fetch();
+            return;
+        }
+
+        // Send transport anchor if it changed or drifted
+        if (transport_.fetch()) {
+            processTransport(transport_.front());
+        }
+
         // Send individual param updates
         for (const auto& p : params) {
             sendToJs("param", "{\"id\":" + std::to_string(p.id) +
                               ",\"v\":" + std::to_string(p.value) + "}");
         }
 
-        // Send bulk param updates
-        if (!bulkParams.empty()) {
+        // Send bulk param updates (snapshot first, then queued bulk entries)
+        if (snapshot || !bulkParams.empty()) {
             std::ostringstream ss;
             ss << "{\"params\":[";
-            for (size_t i = 0; i < bulkParams.size(); ++i) {
-                if (i > 0) ss << ",";
-                ss << "{\"id\":" << bulkParams[i].first
-                   << ",\"v\":" << bulkParams[i].second << "}";
+            bool first = true;
+            if (snapshot) {
+                for (int i = 0; i < snapshot->count; ++i) {
+                    if (!first) ss << ",";
+                    first = false;
+                    ss << "{\"id\":" << snapshotParamId(i) << ",\"v\":" << snapshot->values[i] << "}";
+                }
+            }
+            for (const auto& p : bulkParams) {
+                if (!first) ss << ",";
+                first = false;
+                ss << "{\"id\":" << p.first << ",\"v\":" << p.second << "}";
             }
             ss << "]}";
             sendToJs("params", ss.str());
@@ -188,11 +555,103 @@ public:
         }
     }
 
+    /**
+     * Pause traffic to JS, e.g. while the view is parked
+     * processQueue() keeps draining the queues but only remembers the latest
+     * value per param; notes, CCs and sendData() are dropped.
+     * Must be called on UI/main thread
+     */
+    void pause() {
+        paused_ = true;
+    }
+
+    /**
+     * Resume traffic to JS, sending params that changed while paused
+     * Must be called on UI/main thread
+     */
+    void resume() {
+        if (!paused_) return;
+        paused_ = false;
+        resendTransport();
+
+        if (!webview_ || pausedParams_.empty()) return;
+        std::ostringstream ss;
+        ss << "{\"params\":[";
+        bool first = true;
+        for (const auto& p : pausedParams_) {
+            if (!first) ss << ",";
+            first = false;
+            ss << "{\"id\":" << p.first << ",\"v\":" << p.second << "}";
+        }
+        ss << "]}";
+        pausedParams_.clear();
+        sendToJs("params", ss.str());
+    }
+
+    bool isPaused() const {
+        return paused_;
+    }
+
+    /**
+     * Force the next transport update to be sent (e.g., after the page reloads)
+     */
+    void resendTransport() {
+        transportSent_ = false;
+    }
+
+    /**
+     * Send a block of float data (spectrum, scope, waveform) on a named channel
+     * Delivered to clasp.onData(channel, ...) as a Float32Array. The payload is
+     * passed to JS as base64 without JSON parsing, so it can be decoded in a Worker.
+     * Must be called on UI/main thread
+     */
+    void sendData(const std::string& channel, const float* data, size_t count) {
+        if (!webview_ || !data || paused_) return;
+        std::string js;
+        js.reserve(channel.size() + count * 16 / 3 + 32);
+        js += "__clasp_data('";
+        js += escapeJs(channel);
+        js += "','";
+        appendBase64(js, reinterpret_cast<const uint8_t*>(data), count * sizeof(float));
+        js += "');";
+        webview_->evaluateScript(js);
+    }
+
     /**
      * Send the ready signal to JS
      */
     void sendReady() {
-        sendToJs("ready", "{}");
+        if (webview_) {
+            webview_->markStartup(clasp_gui::StartupPhase::Ready);
+        }
+
+        // Announce cacheable functions so JS can dedupe their first calls
+        std::string payload = "{\"cacheable\":[";
+        {
+            std::lock_guard<std::mutex> lock(handlersMutex_);
+            bool first = true;
+            for (const auto& entry : cacheableCalls_) {
+                if (!first) payload += ',';
+                first = false;
+                payload += "\"" + escapeJson(entry.first) + "\"";
+            }
+        }
+        payload += "],\"v\":" + std::to_string(PROTOCOL_VERSION) + "}";
+        sendToJs("ready", payload);
+    }
+
+    /**
+     * Protocol version reported by clasp.js when the page loaded (0 until then)
+     */
+    int getJsProtocolVersion() const {
+        return jsVersion_;
+    }
+
+    /**
+     * True once clasp.js has reported a matching protocol version
+     */
+    bool isProtocolVersionMatch() const {
+        return jsVersion_ == PROTOCOL_VERSION;
     }
 
     /**
@@ -206,6 +665,58 @@ public:
     }
 
 private:
+    struct TransportAnchor {
+        TransportState state;
+        std::chrono::steady_clock::time_point time;
+    };
+
+    void processTransport(const TransportAnchor& anchor) {
+        const auto& st = anchor.state;
+        const auto& sent = lastTransport_.state;
+
+        bool changed = !transportSent_ ||
+                       st.playing != sent.playing ||
+                       st.tempo != sent.tempo ||
+                       st.timeSigNumerator != sent.timeSigNumerator ||
+                       st.timeSigDenominator != sent.timeSigDenominator;
+
+        if (!changed) {
+            // Where JS thinks the playhead is at the anchor time
+            double predicted = sent.beatPosition;
+            if (sent.playing) {
+                std::chrono::duration<double> elapsed = anchor.time - lastTransport_.time;
+                predicted += elapsed.count() * sent.tempo / 60.0;
+            }
+            double drift = st.beatPosition - predicted;
+            if (drift < 0) drift = -drift;
+            if (drift <= transportDriftBeats_) return;
+        }
+
+        // Age of the anchor lets JS place it on its own clock
+        std::chrono::duration<double, std::milli> age = std::chrono::steady_clock::now() - anchor.time;
+
+        std::ostringstream ss;
+        ss.precision(10);
+        ss << "{\"bpm\":" << st.tempo
+           << ",\"num\":" << st.timeSigNumerator
+           << ",\"den\":" << st.timeSigDenominator
+           << ",\"playing\":" << (st.playing ? "true" : "false")
+           << ",\"beat\":" << st.beatPosition
+           << ",\"age\":" << age.count() << "}";
+        sendToJs("transport", ss.str());
+
+        lastTransport_ = anchor;
+        transportSent_ = true;
+    }
+
+    // Ask an already loaded page to repeat its handshake: pooled views load
+    // before any Protocol binds __clasp, so their first hello went nowhere
+    void requestHello() {
+        if (webview_) {
+            webview_->evaluateScript("if (window.__clasp_recv) __clasp_recv('{\"t\":\"hello\"}');");
+        }
+    }
+
     void setupBinding() {
         if (!webview_) return;
 
@@ -247,6 +758,62 @@ private:
             return "{}";
         }
 
+        // A batch from clasp.js: [{...}, {...}] - replies go back in one batch too
+        if (msgJson[0] == '[') {
+            handleBatch(msgJson);
+            return "{}";
+        }
+
+        return dispatchMessage(msgJson);
+    }
+
+    void handleBatch(const std::string& batchJson) {
+        inBatch_ = true;
+
+        // Dispatch each top-level object in order
+        auto objStart = batchJson.find('{');
+        while (objStart != std::string::npos) {
+            auto objEnd = findClosingBracket(batchJson, objStart);
+            if (objEnd == std::string::npos) break;
+            dispatchMessage(batchJson.substr(objStart, objEnd - objStart + 1));
+            objStart = batchJson.find('{', objEnd + 1);
+        }
+
+        inBatch_ = false;
+
+        // Deliver batched messages, one call per type
+        if (!batchedMessages_.empty()) {
+            auto batched = std::move(batchedMessages_);
+            batchedMessages_.clear();
+            for (const auto& entry : batched) {
+                MessageBatchHandler handler;
+                {
+                    std::lock_guard<std::mutex> lock(handlersMutex_);
+                    auto it = messageBatchHandlers_.find(entry.first);
+                    if (it != messageBatchHandlers_.end()) handler = it->second;
+                }
+                if (!handler) continue;
+                try {
+                    handler(entry.second);
+                } catch (const std::exception&) {
+                    // No reply channel for messages - drop
+                }
+            }
+        }
+
+        if (!batchedReplies_.empty()) {
+            std::string msg = "[";
+            for (size_t i = 0; i < batchedReplies_.size(); ++i) {
+                if (i > 0) msg += ",";
+                msg += batchedReplies_[i];
+            }
+            msg += "]";
+            batchedReplies_.clear();
+            webview_->evaluateScript("__clasp_recv('" + escapeJs(msg) + "');");
+        }
+    }
+
+    std::string dispatchMessage(const std::string& msgJson) {
         // Parse the message type
         std::string msgType;
         auto tPos = msgJson.find("\"t\"");
@@ -261,37 +828,118 @@ private:
 
         if (msgType == "call") {
             return handleCall(msgJson);
+        } else if (msgType == "set") {
+            handleSetParams(msgJson);
+            return "{}";
+        } else if (msgType == "gesture") {
+            uint32_t paramId = 0;
+            if (!extractParamId(msgJson, paramId)) return "{}";
+            bool on = extractIntField(msgJson, "\"on\"", 0) != 0;
+            if (on) {
+                beginGesture(paramId);
+            } else {
+                endGesture(paramId);
+            }
+            uiParamQueue_.push({on ? ParamChange::Type::GestureBegin
+                                   : ParamChange::Type::GestureEnd, paramId, 0.0f});
+            return "{}";
         } else if (msgType == "msg") {
             // Fire-and-forget message from JS
-            // Could add a message callback here if needed
+            handleUserMessage(msgJson);
+            return "{}";
+        } else if (msgType == "hello") {
+            // Handshake: clasp.js reports its protocol version on load
+            jsVersion_ = extractIntField(msgJson, "\"v\"", 0);
+            return "{}";
+        } else if (msgType == "mark") {
+            // Page-side startup phase, timed on arrival
+            handleStartupMark(extractStringField(msgJson, "\"p\""));
             return "{}";
         }
 
         return "{}";
     }
 
-    std::string handleCall(const std::string& msgJson) {
-        // Extract function name
-        std::string fnName;
-        auto fnPos = msgJson.find("\"fn\"");
-        if (fnPos != std::string::npos) {
-            auto colonPos = msgJson.find(':', fnPos);
-            auto quoteStart = msgJson.find('"', colonPos);
-            auto quoteEnd = msgJson.find('"', quoteStart + 1);
-            if (quoteStart != std::string::npos && quoteEnd != std::string::npos) {
-                fnName = msgJson.substr(quoteStart + 1, quoteEnd - quoteStart - 1);
+    void handleStartupMark(const std::string& name) {
+        if (!webview_) return;
+
+        using clasp_gui::StartupPhase;
+        for (int i = 0; i < static_cast<int>(StartupPhase::Count); ++i) {
+            auto phase = static_cast<StartupPhase>(i);
+            if (name == clasp_gui::WebView::getStartupPhaseName(phase)) {
+                webview_->markStartup(phase);
+                // Keep clasp.timings() current
+                sendToJs("timings", "{\"phases\":" + webview_->getStartupTimelineJson() + "}");
+                return;
             }
         }
+    }
+
+    void handleUserMessage(const std::string& msgJson) {
+        std::string type = extractStringField(msgJson, "\"type\"");
+        std::string payload = extractRawField(msgJson, "\"payload\"");
 
-        // Extract call ID
-        int callId = 0;
-        auto idPos = msgJson.find("\"id\"");
-        if (idPos != std::string::npos) {
-            auto colonPos = msgJson.find(':', idPos);
-            if (colonPos != std::string::npos) {
-                callId = std::atoi(msgJson.c_str() + colonPos + 1);
+        // Handlers are called unlocked so they may use the Protocol
+        MessageBatchHandler batchHandler;
+        MessageHandler handler;
+        {
+            std::lock_guard<std::mutex> lock(handlersMutex_);
+            auto batchIt = messageBatchHandlers_.find(type);
+            if (batchIt != messageBatchHandlers_.end()) {
+                batchHandler = batchIt->second;
+            } else {
+                auto it = messageHandlers_.find(type);
+                if (it != messageHandlers_.end()) handler = it->second;
+            }
+        }
+
+        try {
+            if (batchHandler) {
+                if (inBatch_) {
+                    batchedMessages_[type].push_back(std::move(payload));
+                    return;
+                }
+                batchHandler({payload});
+            } else if (handler) {
+                handler(payload);
             }
+        } catch (const std::exception&) {
+            // No reply channel for messages - drop
         }
+    }
+
+    void handleSetParams(const std::string& msgJson) {
+        // Flat [id, value, id, value, ...] array, e.g. {"t":"set","p":[0,0.5,3,0.25]}
+        auto pPos = msgJson.find("\"p\"");
+        if (pPos == std::string::npos) return;
+        auto bracketStart = msgJson.find('[', pPos);
+        if (bracketStart == std::string::npos) return;
+
+        const char* cursor = msgJson.c_str() + bracketStart + 1;
+        for (;;) {
+            char* end = nullptr;
+            double id = std::strtod(cursor, &end);
+            if (end == cursor) break;
+            cursor = end;
+            while (*cursor == ',' || *cursor == ' ') ++cursor;
+
+            double value = std::strtod(cursor, &end);
+            if (end == cursor) break;
+            cursor = end;
+            while (*cursor == ',' || *cursor == ' ') ++cursor;
+
+            // Skip ids that are not a CLAP id; drop the edit if the audio
+            // thread has fallen behind
+            if (!(id >= 0 && id <= UINT32_MAX) || id != std::floor(id)) continue;
+            uiParamQueue_.push({ParamChange::Type::Value,
+                                static_cast<uint32_t>(id), static_cast<float>(value)});
+        }
+    }
+
+    std::string handleCall(const std::string& msgJson) {
+        // Extract function name and call ID
+        std::string fnName = extractStringField(msgJson, "\"fn\"");
+        int callId = extractIntField(msgJson, "\"id\"", 0);
 
         // Extract args array
         std::string argsArray = "[]";
@@ -300,55 +948,161 @@ private:
             auto colonPos = msgJson.find(':', argsPos);
             auto bracketStart = msgJson.find('[', colonPos);
             if (bracketStart != std::string::npos) {
-                int depth = 1;
-                size_t bracketEnd = bracketStart + 1;
-                while (bracketEnd < msgJson.size() && depth > 0) {
-                    if (msgJson[bracketEnd] == '[') depth++;
-                    else if (msgJson[bracketEnd] == ']') depth--;
-                    bracketEnd++;
+                auto bracketEnd = findClosingBracket(msgJson, bracketStart);
+                if (bracketEnd != std::string::npos) {
+                    argsArray = msgJson.substr(bracketStart, bracketEnd - bracketStart + 1);
                 }
-                argsArray = msgJson.substr(bracketStart, bracketEnd - bracketStart);
             }
         }
 
-        // Find and call handler
-        std::string result;
+        // Find the handler; call it unlocked so it may use the Protocol
+        // (e.g. invalidateCacheTag() after saving a preset)
+        CallHandler handler;
+        bool cacheable = false;
         {
             std::lock_guard<std::mutex> lock(handlersMutex_);
             auto it = callHandlers_.find(fnName);
             if (it != callHandlers_.end()) {
-                try {
-                    result = it->second(argsArray);
-                } catch (const std::exception& e) {
-                    // Send error reply
-                    sendReply(callId, "", e.what());
-                    return "{}";
-                }
-            } else {
-                sendReply(callId, "", "unknown function: " + fnName);
-                return "{}";
+                handler = it->second;
+                cacheable = cacheableCalls_.count(fnName) != 0;
             }
         }
+        if (!handler) {
+            sendReply(callId, "", "unknown function: " + fnName);
+            return "{}";
+        }
+
+        std::string result;
+        try {
+            result = handler(argsArray);
+        } catch (const std::exception& e) {
+            // Send error reply
+            sendReply(callId, "", e.what());
+            return "{}";
+        }
 
         // Send reply
-        sendReply(callId, result, "");
+        sendReply(callId, result, "", cacheable);
         return "{}";
     }
 
-    void sendReply(int callId, const std::string& result, const std::string& error) {
+    // Find the ']' or '}' matching the bracket at openPos, skipping string contents
+    static size_t findClosingBracket(const std::string& json, size_t openPos) {
+        int depth = 0;
+        bool inString = false;
+        for (size_t i = openPos; i < json.size(); ++i) {
+            char c = json[i];
+            if (inString) {
+                if (c == '\\') ++i;
+                else if (c == '"') inString = false;
+            } else if (c == '"') {
+                inString = true;
+            } else if (c == '[' || c == '{') {
+                ++depth;
+            } else if ((c == ']' || c == '}') && --depth == 0) {
+                return i;
+            }
+        }
+        return std::string::npos;
+    }
+
+    // Simple field extraction for flat message objects, e.g. "fn":"name"
+    static std::string extractStringField(const std::string& json, const char* key) {
+        auto keyPos = json.find(key);
+        if (keyPos == std::string::npos) return {};
+        auto colonPos = json.find(':', keyPos);
+        auto quoteStart = json.find('"', colonPos);
+        if (quoteStart == std::string::npos) return {};
+        auto quoteEnd = json.find('"', quoteStart + 1);
+        if (quoteEnd == std::string::npos) return {};
+        return json.substr(quoteStart + 1, quoteEnd - quoteStart - 1);
+    }
+
+    // Raw JSON value extraction (object, array, string or literal), "null" if missing
+    static std::string extractRawField(const std::string& json, const char* key) {
+        auto keyPos = json.find(key);
+        if (keyPos == std::string::npos) return "null";
+        auto colonPos = json.find(':', keyPos);
+        if (colonPos == std::string::npos) return "null";
+        auto valueStart = json.find_first_not_of(" \t", colonPos + 1);
+        if (valueStart == std::string::npos) return "null";
+
+        size_t valueEnd = std::string::npos;
+        char c = json[valueStart];
+        if (c == '{' || c == '[') {
+            valueEnd = findClosingBracket(json, valueStart);
+        } else if (c == '"') {
+            for (size_t i = valueStart + 1; i < json.size(); ++i) {
+                if (json[i] == '\\') ++i;
+                else if (json[i] == '"') { valueEnd = i; break; }
+            }
+        } else {
+            auto literalEnd = json.find_first_of(",}", valueStart);
+            if (literalEnd != std::string::npos) valueEnd = literalEnd - 1;
+        }
+
+        if (valueEnd == std::string::npos) return "null";
+        return json.substr(valueStart, valueEnd - valueStart + 1);
+    }
+
+    // CLAP param id field, e.g. "id":3000000000; false if missing or out of range
+    static bool extractParamId(const std::string& json, uint32_t& id) {
+        auto keyPos = json.find("\"id\"");
+        if (keyPos == std::string::npos) return false;
+        auto colonPos = json.find(':', keyPos);
+        if (colonPos == std::string::npos) return false;
+        const char* start = json.c_str() + colonPos + 1;
+        char* end = nullptr;
+        long long value = std::strtoll(start, &end, 10);
+        if (end == start || value < 0 || value > UINT32_MAX) return false;
+        id = static_cast<uint32_t>(value);
+        return true;
+    }
+
+    // Integer (or boolean) field extraction, e.g. "id":42 or "on":true
+    static int extractIntField(const std::string& json, const char* key, int fallback) {
+        auto keyPos = json.find(key);
+        if (keyPos == std::string::npos) return fallback;
+        auto colonPos = json.find(':', keyPos);
+        if (colonPos == std::string::npos) return fallback;
+        auto valuePos = json.find_first_not_of(" \t", colonPos + 1);
+        if (valuePos == std::string::npos) return fallback;
+        if (json.compare(valuePos, 4, "true") == 0) return 1;
+        if (json.compare(valuePos, 5, "false") == 0) return 0;
+        return std::atoi(json.c_str() + valuePos);
+    }
+
+    void sendReply(int callId, const std::string& result, const std::string& error,
+                   bool cacheable = false) {
         std::ostringstream ss;
         ss << "{\"t\":\"reply\",\"id\":" << callId;
         if (!error.empty()) {
             ss << ",\"error\":\"" << escapeJson(error) << "\"";
         } else {
             ss << ",\"result\":" << (result.empty() ? "null" : result);
+            if (cacheable) ss << ",\"cache\":true";
         }
         ss << "}";
 
+        if (inBatch_) {
+            batchedReplies_.push_back(ss.str());
+            return;
+        }
+
         std::string js = "__clasp_recv('" + escapeJs(ss.str()) + "');";
         webview_->evaluateScript(js);
     }
 
+    void sendInvalidate(const std::vector<std::string>& names) {
+        std::string payload = "{\"fns\":[";
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (i > 0) payload += ',';
+            payload += "\"" + escapeJson(names[i]) + "\"";
+        }
+        payload += "]}";
+        sendToJs("invalidate", payload);
+    }
+
     void sendToJs(const std::string& type, const std::string& payload) {
         std::string msg = "{\"t\":\"" + type + "\"";
         // Merge payload object into message
@@ -361,6 +1115,27 @@ private:
         webview_->evaluateScript(js);
     }
 
+    static void appendBase64(std::string& out, const uint8_t* bytes, size_t size) {
+        static const char table[] =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        size_t i = 0;
+        for (; i + 2 < size; i += 3) {
+            uint32_t n = (uint32_t(bytes[i]) << 16) | (uint32_t(bytes[i + 1]) << 8) | bytes[i + 2];
+            out += table[(n >> 18) & 63];
+            out += table[(n >> 12) & 63];
+            out += table[(n >> 6) & 63];
+            out += table[n & 63];
+        }
+        if (i < size) {
+            uint32_t n = uint32_t(bytes[i]) << 16;
+            if (i + 1 < size) n |= uint32_t(bytes[i + 1]) << 8;
+            out += table[(n >> 18) & 63];
+            out += table[(n >> 12) & 63];
+            out += (i + 1 < size) ? table[(n >> 6) & 63] : '=';
+            out += '=';
+        }
+    }
+
     static std::string escapeJs(const std::string& s) {
         std::string result;
         result.reserve(s.size());
@@ -389,7 +1164,7 @@ private:
 
     // Queue structures
     struct ParamUpdate {
-        int id;
+        uint32_t id;
         float value;
     };
 
@@ -411,6 +1186,19 @@ private:
     // Call handlers
     std::mutex handlersMutex_;
     std::unordered_map<std::string, CallHandler> callHandlers_;
+    std::unordered_map<std::string, std::vector<std::string>> cacheableCalls_;  // name -> tags
+
+    // Message handlers
+    std::unordered_map<std::string, MessageHandler> messageHandlers_;
+    std::unordered_map<std::string, MessageBatchHandler> messageBatchHandlers_;
+
+    // Protocol version reported by clasp.js (UI thread only)
+    int jsVersion_ = 0;
+
+    // Replies and messages collected while dispatching a batch (UI thread only)
+    bool inBatch_ = false;
+    std::vector<std::string> batchedReplies_;
+    std::unordered_map<std::string, std::vector<std::string>> batchedMessages_;
 
     // Update queues
     std::mutex queueMutex_;
@@ -419,9 +1207,76 @@ private:
     std::vector<NoteEvent> pendingNotes_;
     std::vector<MidiCCEvent> pendingCCs_;
 
-    // Throttling
-    static constexpr int MAX_PARAMS = 256;
-    std::array<std::chrono::steady_clock::time_point, MAX_PARAMS> lastParamUpdate_;
+    // Paused traffic (UI thread only): latest value per param id
+    bool paused_ = false;
+    std::unordered_map<uint32_t, float> pausedParams_;
+
+    // Param slots: per-param state is indexed by the position of the id in
+    // setParamIds(), found by binary search (real-time safe). Until ids are
+    // registered, id N is slot N.
+    static constexpr int DEFAULT_PARAM_SLOTS = 256;
+    std::vector<uint32_t> paramIds_;
+    std::vector<std::pair<uint32_t, int>> paramLookup_;  // (id, slot), sorted by id
+
+    int paramSlot(uint32_t id) const {
+        if (paramIds_.empty()) {
+            return id < static_cast<uint32_t>(DEFAULT_PARAM_SLOTS) ? static_cast<int>(id) : -1;
+        }
+        auto it = std::lower_bound(paramLookup_.begin(), paramLookup_.end(),
+                                   std::make_pair(id, 0));
+        if (it == paramLookup_.end() || it->first != id) return -1;
+        return it->second;
+    }
+
+    // Param id of snapshot value i
+    uint32_t snapshotParamId(int i) const {
+        return paramIds_.empty() ? static_cast<uint32_t>(i) : paramIds_[i];
+    }
+
+    // Parameter snapshot (audio thread -> UI thread), one value per param slot
+    struct ParamSnapshot {
+        std::vector<float> values;
+        int count = 0;
+    };
+    TripleBuffer<ParamSnapshot> paramSnapshot_;
+
+    void resizeParamSnapshot(size_t slots) {
+        ParamSnapshot empty;
+        empty.values.assign(slots, 0.0f);
+        paramSnapshot_.reset(empty);
+    }
+
+    // Transport (audio thread -> UI thread); last* is UI thread only
+    TripleBuffer<TransportAnchor> transport_;
+    TransportAnchor lastTransport_;
+    bool transportSent_ = false;
+    double transportDriftBeats_ = 0.05;
+
+    // Throttling, per param slot
+    std::vector<std::chrono::steady_clock::time_point> lastParamUpdate_;
+
+    // UI -> audio parameter edits
+    static constexpr size_t UI_PARAM_QUEUE_SIZE = 1024;
+    SpscQueue<ParamChange, UI_PARAM_QUEUE_SIZE> uiParamQueue_;
+
+    // UI gesture tracking (echo suppression): one word per param slot so
+    // "active" and "value pending" change together; the low 32 bits hold the value
+    static constexpr uint64_t GESTURE_ACTIVE = 1ull << 33;
+    static constexpr uint64_t GESTURE_PENDING = 1ull << 32;
+    std::vector<std::atomic<uint64_t>> gestureState_;
+
+    static uint64_t packGestureValue(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return GESTURE_ACTIVE | GESTURE_PENDING | bits;
+    }
+
+    static float unpackGestureValue(uint64_t state) {
+        uint32_t bits = static_cast<uint32_t>(state);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
     std::chrono::milliseconds updateInterval_{16};  // ~60Hz
 };
 
@@ -32,11 +32,44 @@ constexpr bool isLinux() {
 
 // Platform-specific embedding functions
 // These are implemented in platform/*.cpp files
+// `webview` here is a native window: NSView, HWND or X Window (see below)
+
+// Native window of an engine view (CHOC's getViewHandle()) for the functions
+// below: the handle itself on macOS and Windows; on Linux the X window of
+// the GTK toplevel holding the WebKitWebView, created on first use
+void* getEmbeddableWindow(void* engineView);
+
+// Free what getEmbeddableWindow() made; call once the engine view is destroyed
+void releaseEmbeddableWindow(void* window);
 
 bool embedWebView(void* parent, void* webview, int width, int height);
 bool resizeWebView(void* webview, int width, int height);
 bool removeWebView(void* webview);
 
+// Apply resizes still waiting for the next frame (Linux coalesces them)
+void flushPendingResizes();
+
+// Whether resizeWebView() coalesces sizes per frame (X11 with WebKitGTK,
+// whose main loop applies the last one); elsewhere each size goes out at once
+bool coalescesResizes();
+
+// Lightweight native child window shown while a webview loads
+// Resize with resizeWebView()
+void* createPlaceholder(void* parent, int width, int height);
+void destroyPlaceholder(void* placeholder);
+
+// Configure the process-wide web context before the first view is created
+// (process model, cache, spell checker, JS heap limit); only called when the
+// view opted in with WebViewOptions::processWideSettings
+// Returns false where the platform manages web processes itself, or if a
+// requested setting is not supported by the engine version
+bool configureWebContext(const WebViewOptions& options);
+
+// Apply per-view engine settings (lean profile, compositing policy) to an
+// engine view (CHOC's getViewHandle(): WebKitWebView* on Linux)
+// Returns false where the platform has no such settings
+bool applyViewSettings(void* engineView, const WebViewOptions& options);
+
 // Platform-specific fixes
 void initPlatformFixes(void* webview);
 
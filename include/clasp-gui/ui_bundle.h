@@ -0,0 +1,53 @@
+#pragma once
+
+#include "webview.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace clasp_gui {
+
+// Web UI directory embedded at build time by clasp_gui_add_ui_bundle()
+// Files live in the binary's read-only data: stored files are served from
+// there directly, compressed ones are inflated on demand into a small LRU
+// shared by all bundles and instances in the process.
+class UiBundle {
+public:
+    // One file; generated, sorted by path
+    struct Entry {
+        const char* path;       // "/index.html"
+        uint32_t offset;        // Into the bundle data
+        uint32_t storedSize;    // Bytes in the bundle data
+        uint32_t size;          // Bytes after decompression
+        bool compressed;        // zlib-deflated
+        const char* etag;       // Quoted content hash, e.g. "\"3f2a...\""
+    };
+
+    UiBundle(const Entry* entries, size_t count, const uint8_t* data)
+        : entries_(entries), count_(count), data_(data) {}
+
+    // Look up a file (binary search); nullptr if missing
+    const Entry* find(const std::string& path) const;
+
+    // File contents and MIME type; nullopt if missing or undecodable
+    std::optional<WebResource> fetch(const std::string& path) const;
+
+    // Provider for WebViewOptions::resourceProvider
+    ResourceProvider provider() const;
+
+    size_t size() const { return count_; }
+    const Entry* begin() const { return entries_; }
+    const Entry* end() const { return entries_ + count_; }
+
+    // Budget for inflated files kept in the shared LRU (default 8 MB)
+    static void setCacheBudget(size_t bytes);
+
+private:
+    const Entry* entries_;
+    size_t count_;
+    const uint8_t* data_;
+};
+
+} // namespace clasp_gui
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
 namespace clasp_gui {
 
@@ -21,12 +26,70 @@ struct NativeWindow {
     void* handle = nullptr;
 };
 
+// A resource served from memory through the custom scheme
+struct WebResource {
+    std::vector<uint8_t> data;
+    std::string mimeType;  // Empty: derived from the path extension
+};
+
+// Returns the resource for a path such as "/index.html", or nullopt (404)
+using ResourceProvider = std::function<std::optional<WebResource>(const std::string& path)>;
+
+// How the engine composites pages
+enum class CompositingPolicy {
+    Default,  // Engine default
+    Always,   // GPU compositing
+    Never     // Software rendering, e.g. on boxes without a usable GPU
+};
+
 // WebView options
 struct WebViewOptions {
     bool enableDebugMode = false;      // Enable dev tools (right-click inspect, etc.)
     bool openDevToolsOnStart = false;  // Open dev tools inspector window on creation
     bool disableContextMenu = false;   // Disable right-click context menu
     std::string initScript;            // Additional JS to inject on load
+
+    // Allow settings that change state shared by every view in the host
+    // process, other plugins' included: the environment (the JS heap limit,
+    // and all engine switches on WebView2) and the default WebKitGTK context
+    // (process model, cache, spell checker). Setting the environment is not
+    // thread-safe while host threads read it. Off by default; when on, these
+    // are taken from the first view created and only work before any web
+    // process has started.
+    bool processWideSettings = false;
+
+    // Web process sharing (process-wide, needs processWideSettings)
+    // Only WebKitGTK before 2.26 supports these; later versions always run
+    // one web process per view, and a warning is logged if they are set
+    bool shareWebProcess = false;      // One web process for all views (WebKitGTK < 2.26)
+    int webProcessLimit = 0;           // Max web processes, 0 = WebKit default (WebKitGTK < 2.26)
+
+    // Lean profile: turn off engine features plugin UIs rarely need (WebGL,
+    // media playback and plugins; with processWideSettings also the resource
+    // cache and the spell checker)
+    bool leanProfile = false;
+    CompositingPolicy compositing = CompositingPolicy::Default;  // Process-wide on WebView2
+    int jsHeapLimitMb = 0;             // Max JS heap per web process, 0 = engine default
+                                       // (process-wide, needs processWideSettings)
+
+    // Serve the UI from memory: requests under getResourceRootUrl() go to the
+    // provider instead of the filesystem. Called on the UI/main thread.
+    ResourceProvider resourceProvider;
+    std::string resourceScheme = "clasp";
+};
+
+// Startup phases of a view, in the order they normally happen
+enum class StartupPhase {
+    Create,            // create() called (or the view taken from a pool)
+    Created,           // Native view exists
+    SetParent,         // setParent() stored the host window
+    Embedded,          // First setSize() after it reparented the view
+    Navigate,          // navigate() or loadHtml()
+    DomContentLoaded,  // Reported by clasp.js
+    FirstFrame,        // First animation frame after DOMContentLoaded (clasp.js)
+    Ready,             // clasp::Protocol::sendReady()
+    ReadyApplied,      // clasp.js handled 'ready'
+    Count
 };
 
 // Forward declaration
@@ -59,6 +122,9 @@ public:
     // Window embedding
     bool setParent(const NativeWindow& parent);
     bool setSize(uint32_t width, uint32_t height);
+
+    // Remove from the parent window but keep the page alive
+    bool detach();
     bool show();
     bool hide();
 
@@ -67,25 +133,68 @@ public:
 
     // Navigation
     void navigate(const std::string& url);
+
+    // Root URL of the resource provider's scheme, e.g. "clasp://ui/"
+    // ("https://clasp.localhost/" on Windows, where WebView2 needs https)
+    std::string getResourceRootUrl() const;
+
+    // MIME type for a file extension, e.g. "text/html" for "/index.html"
+    static std::string mimeTypeForPath(const std::string& path);
     void loadHtml(const std::string& html);
 
     // JavaScript execution (fire-and-forget)
     void evaluateScript(const std::string& js);
 
+    // Add a script run before the page's own scripts on every navigation
+    // May be called before create(); applies from the next navigation
+    void addInitScript(const std::string& js);
+
+    // Add the library's embedded clasp.js as an init script (once)
+    void injectClaspJs();
+
+    // clasp.js as embedded in the library (comments stripped)
+    static const std::string& getEmbeddedClaspJs();
+
     // Open developer tools (requires enableDebugMode = true)
     // Uses platform-specific keyboard simulation (UNTESTED)
     void openDevTools();
 
     // Bind a C++ function callable from JS
     // The function is exposed globally as window.<name>
+    // May be called before create(); binding a name again replaces the callback
     using BindingCallback = std::function<std::string(const std::string& argsJson)>;
     void bind(const std::string& name, BindingCallback callback);
 
+    // Drop all callbacks (JS calls then return null), e.g. before handing the
+    // view to a new owner
+    void clearBindings();
+
+    // Run a bound callback as a call from JS would (headless use, tests)
+    // Returns its JSON result; empty if nothing is bound under that name
+    std::string invokeBinding(const std::string& name, const std::string& argsJson);
+
+    // Startup timeline (UI thread): monotonic time each phase was first reached
+    // Page phases arrive through clasp::Protocol
+    using TimePoint = std::chrono::steady_clock::time_point;
+    void markStartup(StartupPhase phase);
+    std::optional<TimePoint> getStartupTime(StartupPhase phase) const;
+
+    // Milliseconds from Create to the phase, -1 if either was not reached
+    double getStartupMs(StartupPhase phase) const;
+
+    // Reached phases as {"create":0,"created":4.2,...} (milliseconds)
+    std::string getStartupTimelineJson() const;
+    void resetStartupTimeline();
+
+    // "create", "domContentLoaded", ...
+    static const char* getStartupPhaseName(StartupPhase phase);
+
 private:
     struct Impl;
     std::unique_ptr<Impl> impl_;
 
     WebViewOptions options_;
+    std::array<TimePoint, static_cast<size_t>(StartupPhase::Count)> startup_{};
 };
 
 } // namespace clasp_gui
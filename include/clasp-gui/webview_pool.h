@@ -0,0 +1,118 @@
+#pragma once
+
+#include "webview.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace clasp_gui {
+
+// WebView pool options
+struct WebViewPoolOptions {
+    size_t size = 1;                                // Views kept created and loaded
+    std::chrono::milliseconds idleTimeout{300000};  // Destroy views idle this long (0 = never)
+    std::string url;                                // Page to pre-load into pooled views
+    WebViewOptions webViewOptions;                  // Options for views created by the pool
+
+    // Memory budget for parked views (see park()); the least recently parked
+    // views are evicted once parked views * viewMemoryEstimate exceeds it
+    size_t parkBudget = 512u << 20;
+    size_t viewMemoryEstimate = 96u << 20;          // Typical resident size of one view
+};
+
+// WebView pool statistics
+struct WebViewPoolStats {
+    uint64_t hits = 0;      // acquire() served by a pre-warmed view
+    uint64_t misses = 0;    // acquire() had to create a view
+    uint64_t created = 0;   // Views created in total
+    uint64_t expired = 0;   // Views destroyed by the idle timeout
+    size_t idle = 0;        // Views currently waiting in the pool
+    size_t leased = 0;      // Views currently handed out
+    size_t parked = 0;      // Views currently parked by their owners
+    uint64_t evicted = 0;   // Parked views evicted to stay within the budget
+};
+
+// Process-wide pool of created, pre-navigated WebViews
+// Opening an editor leases a warm view instead of paying the full cold start
+// (view creation plus page load and parse); closing it returns the view.
+// All methods must be called on the UI/main thread.
+class WebViewPool {
+public:
+    WebViewPool() = default;
+    ~WebViewPool();
+
+    // Non-copyable
+    WebViewPool(const WebViewPool&) = delete;
+    WebViewPool& operator=(const WebViewPool&) = delete;
+
+    // The pool shared by all plugin instances in this process
+    static WebViewPool& shared();
+
+    // Set size, idle timeout, URL and view options
+    // Idle views created with different options are destroyed; views with a
+    // resourceProvider always are, since providers cannot be compared
+    void configure(const WebViewPoolOptions& options);
+    WebViewPoolOptions getOptions() const;
+
+    // Create and load views until the pool holds `size` idle views
+    // Call when the plugin is created or from an idle timer, not while opening an editor
+    void warm();
+
+    // Lease a view: a warm one if available, otherwise a new one
+    // Returns nullptr if no WebView can be created on this platform
+    std::unique_ptr<WebView> acquire();
+
+    // Return a leased view; it is detached, its bindings cleared and the page
+    // reloaded, or destroyed if the pool is full
+    void release(std::unique_ptr<WebView> view);
+
+    // End a lease without returning the view: it is destroyed, e.g. when an
+    // evicted parked view must free its memory
+    void discard(std::unique_ptr<WebView> view);
+
+    // Register a view its owner keeps alive while the editor is closed
+    // Parking may evict the least recently parked views (possibly this one):
+    // their evict callback is called and must destroy or discard() the view
+    // (release() would only move it to the idle list)
+    using EvictCallback = std::function<void()>;
+    void park(WebView* view, EvictCallback evict);
+
+    // Unregister a parked view (editor reopened or owner going away)
+    void unpark(WebView* view);
+
+    // Destroy views idle longer than the timeout (also done by acquire/release/warm)
+    void trim();
+
+    // Destroy all idle views; call from clap_plugin_entry.deinit
+    void clear();
+
+    WebViewPoolStats getStats() const;
+
+private:
+    struct Entry {
+        std::unique_ptr<WebView> view;
+        std::chrono::steady_clock::time_point idleSince;
+    };
+
+    struct ParkedEntry {
+        WebView* view;
+        EvictCallback evict;
+    };
+
+    std::unique_ptr<WebView> createView();
+    void trimLocked(std::chrono::steady_clock::time_point now);
+
+    mutable std::mutex mutex_;
+    WebViewPoolOptions options_;
+    std::vector<Entry> idle_;  // Most recently returned last
+    std::vector<ParkedEntry> parked_;  // Most recently parked last
+    WebViewPoolStats stats_;
+};
+
+} // namespace clasp_gui
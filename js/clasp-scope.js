@@ -0,0 +1,215 @@
+/**
+ * clasp-scope.js - Optional scope/meter renderer for clasp data channels
+ * Binds a channel from Protocol::sendData() to a canvas. Where OffscreenCanvas
+ * is available, decoding and drawing run in a worker (clasp-worker.js) and the
+ * main thread never sees the sample data. Otherwise frames are drawn on the
+ * main thread, once per animation frame. Include after clasp.js; for the
+ * fallback path also include clasp-worker.js as a plain script.
+ *
+ * Usage:
+ *   clasp.scope.bind(canvas, 'scope', { type: 'scope', min: -1, max: 1 });
+ *   clasp.scope.bind(meterCanvas, 'levels', { type: 'meter' });
+ */
+(function() {
+    'use strict';
+
+    var clasp = window.clasp;
+    if (!clasp) {
+        console.error('clasp-scope: clasp.js must be loaded first');
+        return;
+    }
+
+    var scriptBase = (document.currentScript && document.currentScript.src)
+        ? document.currentScript.src.replace(/[^\/]*$/, '') : '';
+
+    // Shared worker; canvases are only transferred once it reported 'ready',
+    // since a transferred canvas cannot fall back to main-thread drawing
+    var worker = null;
+    var workerState = 'none';  // 'loading', 'ready' or 'failed'
+    var workerWaiters = [];
+    var bindings = {};
+
+    function supportsOffscreen(canvas) {
+        return typeof Worker === 'function' &&
+               typeof OffscreenCanvas === 'function' &&
+               typeof canvas.transferControlToOffscreen === 'function';
+    }
+
+    // Call fn(true) once the worker has loaded, or fn(false) if it cannot
+    function whenWorkerReady(url, fn) {
+        if (workerState === 'ready' || workerState === 'failed') {
+            fn(workerState === 'ready');
+            return;
+        }
+        workerWaiters.push(fn);
+        if (workerState === 'loading') return;
+
+        workerState = 'loading';
+        try {
+            worker = new Worker(url || (scriptBase + 'clasp-worker.js'));
+        } catch (e) {
+            console.error('clasp-scope: could not start worker, drawing on main thread:', e);
+            settleWorker(false);
+            return;
+        }
+        worker.onmessage = function(e) {
+            if (e.data && e.data.type === 'ready') settleWorker(true);
+        };
+        worker.onerror = function(e) {
+            if (workerState === 'loading') {
+                console.error('clasp-scope: worker failed to load, drawing on main thread:',
+                              e.message);
+                worker = null;
+                settleWorker(false);
+            } else {
+                console.error('clasp-scope: worker error:', e.message);
+            }
+        };
+    }
+
+    function settleWorker(ok) {
+        workerState = ok ? 'ready' : 'failed';
+        var waiters = workerWaiters;
+        workerWaiters = [];
+        for (var i = 0; i < waiters.length; i++) waiters[i](ok);
+    }
+
+    // Draw on the main thread, keeping only the newest frame per animation frame
+    function bindMainThread(canvas, channel, style) {
+        if (!clasp.decode) {
+            console.error('clasp-scope: include clasp-worker.js for main-thread drawing');
+            return null;
+        }
+        var ctx = canvas.getContext('2d');
+        var pending = null;
+        var scheduled = false;
+
+        var unsubscribe = clasp.onRawData(channel, function(b64) {
+            pending = b64;
+            if (!scheduled) {
+                scheduled = true;
+                requestAnimationFrame(function() {
+                    scheduled = false;
+                    if (!pending) return;
+                    clasp.decode.render(ctx, canvas.width, canvas.height,
+                                        clasp.decode.decode(pending), style);
+                    pending = null;
+                });
+            }
+        });
+
+        return {
+            offscreen: false,
+            resize: function(width, height) {
+                canvas.width = width;
+                canvas.height = height;
+            },
+            unbind: unsubscribe
+        };
+    }
+
+    // Hand the canvas to the loaded worker and forward raw frames to it
+    function bindOffscreen(canvas, channel, style) {
+        var w = worker;
+        var offscreen = canvas.transferControlToOffscreen();
+        w.postMessage({ type: 'bind', ch: channel, canvas: offscreen, style: style }, [offscreen]);
+
+        var unsubscribe = clasp.onRawData(channel, function(b64) {
+            w.postMessage({ ch: channel, b64: b64 });
+        });
+
+        return {
+            offscreen: true,
+            resize: function(width, height) {
+                w.postMessage({ type: 'resize', ch: channel, width: width, height: height });
+            },
+            unbind: function() {
+                unsubscribe();
+                w.postMessage({ type: 'unbind', ch: channel });
+            }
+        };
+    }
+
+    // Draw in the worker once it has loaded, on the main thread if it fails
+    // to; the handle forwards to whichever binding is made
+    function bindWhenWorkerReady(canvas, channel, style, url) {
+        var inner = null;
+        var unbound = false;
+        var handle = {
+            offscreen: false,
+            resize: function(width, height) {
+                if (inner) {
+                    inner.resize(width, height);
+                } else {
+                    canvas.width = width;
+                    canvas.height = height;
+                }
+            },
+            unbind: function() {
+                unbound = true;
+                if (inner) inner.unbind();
+            }
+        };
+
+        whenWorkerReady(url, function(ok) {
+            if (unbound) return;
+            if (ok) {
+                try {
+                    inner = bindOffscreen(canvas, channel, style);
+                    handle.offscreen = true;
+                    return;
+                } catch (e) {
+                    console.error('clasp-scope: OffscreenCanvas failed, drawing on main thread:', e);
+                }
+            }
+            inner = bindMainThread(canvas, channel, style);
+        });
+        return handle;
+    }
+
+    clasp.scope = {
+        /**
+         * Draw a data channel into a canvas (one canvas per channel)
+         * @param {HTMLCanvasElement} canvas
+         * @param {string} channel - Name passed to Protocol::sendData()
+         * @param {object} [style] - { type: 'scope' | 'spectrum' | 'meter', color,
+         *                             background, lineWidth, min, max, decimate, logX }
+         * @param {object} [options] - { workerUrl, forceMainThread }
+         * @returns {object} handle with resize(width, height), unbind() and offscreen
+         *   flag; offscreen turns true once the worker has loaded and taken the canvas
+         */
+        bind: function(canvas, channel, style, options) {
+            options = options || {};
+            style = style || {};
+            if (bindings[channel]) {
+                bindings[channel].unbind();
+            }
+
+            var dpr = window.devicePixelRatio || 1;
+            canvas.width = Math.round((canvas.clientWidth || canvas.width) * dpr);
+            canvas.height = Math.round((canvas.clientHeight || canvas.height) * dpr);
+
+            var handle = null;
+            if (!options.forceMainThread && supportsOffscreen(canvas)) {
+                handle = bindWhenWorkerReady(canvas, channel, style, options.workerUrl);
+            } else {
+                handle = bindMainThread(canvas, channel, style);
+            }
+            if (handle) {
+                bindings[channel] = handle;
+            }
+            return handle;
+        },
+
+        /**
+         * Stop drawing a channel
+         */
+        unbind: function(channel) {
+            if (bindings[channel]) {
+                bindings[channel].unbind();
+                delete bindings[channel];
+            }
+        }
+    };
+
+})();
@@ -0,0 +1,338 @@
+/**
+ * clasp-widgets.js - Optional canvas widget renderer for clasp.js
+ * Draws knobs, sliders, meters and LEDs into a single canvas, redrawing only
+ * the widgets whose params changed. Include after clasp.js.
+ *
+ * Usage:
+ *   var surface = clasp.widgets.createSurface(canvas);
+ *   surface.add({ type: 'knob', param: 0, x: 10, y: 10, w: 48, h: 48 });
+ */
+(function() {
+    'use strict';
+
+    var clasp = window.clasp;
+    if (!clasp) {
+        console.error('clasp-widgets: clasp.js must be loaded first');
+        return;
+    }
+
+    // Spatial grid cell size for hit-testing (CSS pixels)
+    var GRID_CELL = 64;
+
+    var KNOB_START = 0.75 * Math.PI;
+    var KNOB_SWEEP = 1.5 * Math.PI;
+
+    var defaultTheme = {
+        background: '#1e1e1e',
+        track: '#3a3a3a',
+        fill: '#4fc3f7',
+        pointer: '#ffffff',
+        ledOn: '#66bb6a',
+        ledOff: '#2e3b2f'
+    };
+
+    // Widget painters: draw widget w with value v (0..1) into ctx
+    var painters = {
+        knob: function(ctx, w, v, theme) {
+            var cx = w.x + w.w / 2;
+            var cy = w.y + w.h / 2;
+            var r = Math.min(w.w, w.h) / 2 - 3;
+            var end = KNOB_START + KNOB_SWEEP * v;
+
+            ctx.lineWidth = 3;
+            ctx.strokeStyle = theme.track;
+            ctx.beginPath();
+            ctx.arc(cx, cy, r, KNOB_START, KNOB_START + KNOB_SWEEP);
+            ctx.stroke();
+
+            ctx.strokeStyle = w.color || theme.fill;
+            ctx.beginPath();
+            ctx.arc(cx, cy, r, KNOB_START, end);
+            ctx.stroke();
+
+            ctx.strokeStyle = theme.pointer;
+            ctx.beginPath();
+            ctx.moveTo(cx, cy);
+            ctx.lineTo(cx + Math.cos(end) * r * 0.8, cy + Math.sin(end) * r * 0.8);
+            ctx.stroke();
+        },
+
+        slider: function(ctx, w, v, theme) {
+            ctx.fillStyle = theme.track;
+            ctx.fillRect(w.x, w.y, w.w, w.h);
+            ctx.fillStyle = w.color || theme.fill;
+            if (w.h >= w.w) {
+                var fh = w.h * v;
+                ctx.fillRect(w.x, w.y + w.h - fh, w.w, fh);
+            } else {
+                ctx.fillRect(w.x, w.y, w.w * v, w.h);
+            }
+        },
+
+        meter: function(ctx, w, v, theme) {
+            ctx.fillStyle = theme.track;
+            ctx.fillRect(w.x, w.y, w.w, w.h);
+            var fh = w.h * v;
+            ctx.fillStyle = w.color || (v > 0.9 ? '#ef5350' : theme.ledOn);
+            ctx.fillRect(w.x, w.y + w.h - fh, w.w, fh);
+        },
+
+        led: function(ctx, w, v, theme) {
+            ctx.fillStyle = v > 0.5 ? (w.color || theme.ledOn) : theme.ledOff;
+            ctx.beginPath();
+            ctx.arc(w.x + w.w / 2, w.y + w.h / 2, Math.min(w.w, w.h) / 2 - 1, 0, 2 * Math.PI);
+            ctx.fill();
+        }
+    };
+
+    /**
+     * A canvas holding many widgets
+     * @param {HTMLCanvasElement} canvas
+     * @param {object} [options] - { theme, dragSensitivity }
+     */
+    function Surface(canvas, options) {
+        options = options || {};
+        this.canvas = canvas;
+        this.ctx = canvas.getContext('2d');
+        this.theme = Object.assign({}, defaultTheme, options.theme);
+        this.dragSensitivity = options.dragSensitivity || 0.005;
+        this.widgets = [];
+        this.byParam = [];
+        this.grid = {};
+        this.dirty = [];
+        this.frameScheduled = false;
+        this.scale = 1;
+
+        var self = this;
+        this.onParamsChanged = function(ids) {
+            for (var i = 0; i < ids.length; i++) {
+                var list = self.byParam[ids[i]];
+                if (!list) continue;
+                for (var j = 0; j < list.length; j++) {
+                    // The authoritative value replaces a finished drag's value
+                    if (!list[j].dragging) list[j].localValue = null;
+                    self.invalidate(list[j]);
+                }
+            }
+            // Already inside the mirror's animation frame - draw now
+            self.render();
+        };
+        clasp.on('paramsChanged', this.onParamsChanged);
+
+        this.onPointerDown = function(e) {
+            var rect = canvas.getBoundingClientRect();
+            var w = self.hitTest(e.clientX - rect.left, e.clientY - rect.top);
+            if (w && w.type !== 'meter' && w.type !== 'led') {
+                e.preventDefault();
+                self.beginDrag(w);
+            }
+        };
+        canvas.addEventListener('pointerdown', this.onPointerDown);
+
+        this.resize();
+    }
+
+    /**
+     * Match the canvas backing store to its CSS size and device pixel ratio
+     */
+    Surface.prototype.resize = function() {
+        var dpr = window.devicePixelRatio || 1;
+        var cssW = this.canvas.clientWidth || this.canvas.width;
+        var cssH = this.canvas.clientHeight || this.canvas.height;
+        this.canvas.width = Math.round(cssW * dpr);
+        this.canvas.height = Math.round(cssH * dpr);
+        this.scale = dpr;
+        this.redrawAll();
+    };
+
+    /**
+     * Add a widget: { type, param, x, y, w, h, color? }
+     * type is one of knob, slider, meter, led
+     */
+    Surface.prototype.add = function(widget) {
+        if (!painters[widget.type]) {
+            throw new Error('clasp-widgets: unknown widget type ' + widget.type);
+        }
+        widget.localValue = null;
+        widget.dragging = false;
+        widget.dirty = false;
+        this.widgets.push(widget);
+
+        if (!this.byParam[widget.param]) this.byParam[widget.param] = [];
+        this.byParam[widget.param].push(widget);
+
+        this.forEachCell(widget, function(cell) {
+            cell.push(widget);
+        });
+
+        this.invalidate(widget);
+        return widget;
+    };
+
+    /**
+     * Remove a widget
+     */
+    Surface.prototype.remove = function(widget) {
+        var idx = this.widgets.indexOf(widget);
+        if (idx === -1) return;
+        this.widgets.splice(idx, 1);
+
+        var list = this.byParam[widget.param];
+        list.splice(list.indexOf(widget), 1);
+
+        this.forEachCell(widget, function(cell) {
+            cell.splice(cell.indexOf(widget), 1);
+        });
+
+        if (widget.dirty) {
+            this.dirty.splice(this.dirty.indexOf(widget), 1);
+            widget.dirty = false;
+        }
+
+        this.ctx.setTransform(this.scale, 0, 0, this.scale, 0, 0);
+        this.ctx.fillStyle = this.theme.background;
+        this.ctx.fillRect(widget.x, widget.y, widget.w, widget.h);
+    };
+
+    /**
+     * Detach from clasp and the canvas
+     */
+    Surface.prototype.destroy = function() {
+        clasp.off('paramsChanged', this.onParamsChanged);
+        this.canvas.removeEventListener('pointerdown', this.onPointerDown);
+        this.widgets = [];
+        this.byParam = [];
+        this.grid = {};
+        this.dirty = [];
+    };
+
+    // Internal: call fn with every grid cell the widget overlaps
+    Surface.prototype.forEachCell = function(widget, fn) {
+        var x0 = Math.floor(widget.x / GRID_CELL);
+        var y0 = Math.floor(widget.y / GRID_CELL);
+        var x1 = Math.floor((widget.x + widget.w) / GRID_CELL);
+        var y1 = Math.floor((widget.y + widget.h) / GRID_CELL);
+        for (var gy = y0; gy <= y1; gy++) {
+            for (var gx = x0; gx <= x1; gx++) {
+                var key = gx + ',' + gy;
+                if (!this.grid[key]) this.grid[key] = [];
+                fn(this.grid[key]);
+            }
+        }
+    };
+
+    /**
+     * Find the widget under a point (CSS pixels, canvas-relative)
+     */
+    Surface.prototype.hitTest = function(x, y) {
+        var cell = this.grid[Math.floor(x / GRID_CELL) + ',' + Math.floor(y / GRID_CELL)];
+        if (!cell) return null;
+        for (var i = cell.length - 1; i >= 0; i--) {
+            var w = cell[i];
+            if (x >= w.x && x < w.x + w.w && y >= w.y && y < w.y + w.h) return w;
+        }
+        return null;
+    };
+
+    /**
+     * Mark a widget for redraw in the next frame
+     */
+    Surface.prototype.invalidate = function(widget) {
+        if (!widget.dirty) {
+            widget.dirty = true;
+            this.dirty.push(widget);
+        }
+        if (!this.frameScheduled) {
+            this.frameScheduled = true;
+            var self = this;
+            requestAnimationFrame(function() {
+                self.frameScheduled = false;
+                self.render();
+            });
+        }
+    };
+
+    /**
+     * Redraw every widget
+     */
+    Surface.prototype.redrawAll = function() {
+        var ctx = this.ctx;
+        ctx.setTransform(1, 0, 0, 1, 0, 0);
+        ctx.fillStyle = this.theme.background;
+        ctx.fillRect(0, 0, this.canvas.width, this.canvas.height);
+        for (var i = 0; i < this.widgets.length; i++) {
+            this.invalidate(this.widgets[i]);
+        }
+    };
+
+    /**
+     * Draw the dirty widgets, each clipped to its own rectangle
+     */
+    Surface.prototype.render = function() {
+        if (!this.dirty.length) return;
+        var ctx = this.ctx;
+        var theme = this.theme;
+        var list = this.dirty;
+        this.dirty = [];
+
+        ctx.setTransform(this.scale, 0, 0, this.scale, 0, 0);
+        for (var i = 0; i < list.length; i++) {
+            var w = list[i];
+            w.dirty = false;
+            var v = w.localValue !== null ? w.localValue : clasp.getParam(w.param);
+            if (v === undefined) v = 0;
+
+            ctx.save();
+            ctx.beginPath();
+            ctx.rect(w.x, w.y, w.w, w.h);
+            ctx.clip();
+            ctx.fillStyle = theme.background;
+            ctx.fillRect(w.x, w.y, w.w, w.h);
+            painters[w.type](ctx, w, v < 0 ? 0 : (v > 1 ? 1 : v), theme);
+            ctx.restore();
+        }
+    };
+
+    // Internal: drag a knob or slider; clasp.startDrag() sends the values
+    Surface.prototype.beginDrag = function(widget) {
+        var self = this;
+        var start = clasp.getParam(widget.param);
+        widget.localValue = start === undefined ? 0 : start;
+        widget.dragging = true;
+
+        var horizontal = widget.type === 'slider' && widget.w > widget.h;
+        clasp.startDrag(function(x, y, dx, dy, value) {
+            if (value === widget.localValue) return;
+            widget.localValue = value;
+            self.invalidate(widget);
+        }, function() {
+            // Echoes were suppressed during the drag and the mirror still
+            // holds the old value, so keep showing the dragged value until
+            // C++ sends the one it settled on
+            widget.dragging = false;
+            self.invalidate(widget);
+        }, {
+            paramId: widget.param,
+            value: widget.localValue,
+            sensitivity: self.dragSensitivity,
+            axis: horizontal ? 'x' : 'y'
+        });
+    };
+
+    clasp.widgets = {
+        /**
+         * Create a widget surface on a canvas
+         */
+        createSurface: function(canvas, options) {
+            return new Surface(canvas, options);
+        },
+
+        /**
+         * Register a custom painter: fn(ctx, widget, value, theme)
+         */
+        registerPainter: function(type, fn) {
+            painters[type] = fn;
+        }
+    };
+
+})();
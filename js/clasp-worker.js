@@ -0,0 +1,200 @@
+/**
+ * clasp-worker.js - Decoder for heavy clasp data channels
+ * Runs as a Web Worker started by clasp.useWorker(). Decodes base64 float
+ * blocks from Protocol::sendData(), optionally decimates them and builds a
+ * display path, then posts the results back as transferable ArrayBuffers.
+ *
+ * It also draws scope/meter channels straight into an OffscreenCanvas bound
+ * by clasp-scope.js, so the sample data never reaches the main thread.
+ *
+ * When loaded as a plain <script>, the same functions are exposed as
+ * clasp.decode for main-thread fallback.
+ */
+(function(self) {
+    'use strict';
+
+    // Decode a base64 string of little-endian float32 values
+    function decode(b64) {
+        var bin = atob(b64);
+        var bytes = new Uint8Array(bin.length);
+        for (var i = 0; i < bin.length; i++) {
+            bytes[i] = bin.charCodeAt(i);
+        }
+        return new Float32Array(bytes.buffer, 0, bytes.length >> 2);
+    }
+
+    // Reduce data to n buckets of (min, max) pairs
+    function decimate(data, n) {
+        if (!n || n * 2 >= data.length) return null;
+        var out = new Float32Array(n * 2);
+        var step = data.length / n;
+        for (var b = 0; b < n; b++) {
+            var start = Math.floor(b * step);
+            var end = Math.max(start + 1, Math.floor((b + 1) * step));
+            var lo = data[start], hi = data[start];
+            for (var i = start + 1; i < end; i++) {
+                var v = data[i];
+                if (v < lo) lo = v;
+                if (v > hi) hi = v;
+            }
+            out[b * 2] = lo;
+            out[b * 2 + 1] = hi;
+        }
+        return out;
+    }
+
+    // Build an (x, y) polyline scaled to width x height
+    // opts: { width, height, min = -1, max = 1, logX = false }
+    // For min/max pairs, each bucket contributes a vertical segment
+    function buildPath(values, pairs, opts) {
+        var width = opts.width || 1;
+        var height = opts.height || 1;
+        var min = opts.min !== undefined ? opts.min : -1;
+        var max = opts.max !== undefined ? opts.max : 1;
+        var range = (max - min) || 1;
+        var points = pairs ? values.length / 2 : values.length;
+        var path = new Float32Array(values.length * 2);
+        var logNorm = opts.logX ? 1 / Math.log(points) : 0;
+
+        for (var i = 0; i < values.length; i++) {
+            var p = pairs ? (i >> 1) : i;
+            var fx = points > 1 ? p / (points - 1) : 0;
+            if (logNorm && p > 0) fx = Math.log(p) * logNorm;
+            path[i * 2] = fx * width;
+            path[i * 2 + 1] = height - (values[i] - min) / range * height;
+        }
+        return path;
+    }
+
+    // Decode one frame; returns { data, minmax, path } (all ArrayBuffer-backed)
+    function process(b64, opts) {
+        opts = opts || {};
+        var data = decode(b64);
+        var minmax = decimate(data, opts.decimate);
+        var path = opts.path ? buildPath(minmax || data, !!minmax, opts.path) : null;
+        return { data: data, minmax: minmax, path: path };
+    }
+
+    // Draw a decoded frame into a 2D context
+    // style: { type: 'scope' | 'spectrum' | 'meter', color, background,
+    //          lineWidth, min, max, decimate, logX }
+    function render(ctx, width, height, data, style) {
+        style = style || {};
+        ctx.fillStyle = style.background || '#1e1e1e';
+        ctx.fillRect(0, 0, width, height);
+        ctx.fillStyle = ctx.strokeStyle = style.color || '#4fc3f7';
+
+        var min = style.min !== undefined ? style.min : (style.type === 'meter' ? 0 : -1);
+        var max = style.max !== undefined ? style.max : 1;
+
+        if (!data.length) return;
+
+        if (style.type === 'meter') {
+            // One vertical bar per value (e.g., [L, R] levels)
+            var barW = width / Math.max(1, data.length);
+            for (var m = 0; m < data.length; m++) {
+                var level = Math.min(1, Math.max(0, (data[m] - min) / ((max - min) || 1)));
+                ctx.fillRect(m * barW + 1, height - level * height, barW - 2, level * height);
+            }
+            return;
+        }
+
+        var minmax = decimate(data, style.decimate || Math.floor(width));
+        var path = buildPath(minmax || data, !!minmax,
+                             { width: width, height: height, min: min, max: max, logX: style.logX });
+
+        ctx.lineWidth = style.lineWidth || 1;
+        ctx.beginPath();
+        ctx.moveTo(path[0], path[1]);
+        for (var i = 2; i < path.length; i += 2) {
+            ctx.lineTo(path[i], path[i + 1]);
+        }
+        if (style.type === 'spectrum') {
+            ctx.lineTo(path[path.length - 2], height);
+            ctx.lineTo(path[0], height);
+            ctx.closePath();
+            ctx.fill();
+        } else {
+            ctx.stroke();
+        }
+    }
+
+    var api = {
+        decode: decode,
+        decimate: decimate,
+        buildPath: buildPath,
+        process: process,
+        render: render
+    };
+
+    if (typeof WorkerGlobalScope !== 'undefined' && self instanceof WorkerGlobalScope) {
+        // Canvases bound by clasp-scope.js: ch -> { canvas, ctx, style, pending }
+        var surfaces = {};
+        var frameScheduled = false;
+
+        var nextFrame = self.requestAnimationFrame
+            ? function(fn) { self.requestAnimationFrame(fn); }
+            : function(fn) { setTimeout(fn, 16); };
+
+        // Draw the latest pending frame of each bound channel
+        var drawPending = function() {
+            frameScheduled = false;
+            for (var ch in surfaces) {
+                var sf = surfaces[ch];
+                if (!sf.pending) continue;
+                render(sf.ctx, sf.canvas.width, sf.canvas.height, decode(sf.pending), sf.style);
+                sf.pending = null;
+            }
+        };
+
+        // Worker messages:
+        //   { type: 'bind', ch, canvas, style }    take over an OffscreenCanvas
+        //   { type: 'resize', ch, width, height }  resize a bound canvas
+        //   { type: 'unbind', ch }
+        //   { ch, b64, opts }                      data frame
+        // Unbound data frames are answered with { ch, data, minmax, path }.
+        // { type: 'ready' } is posted once this script has loaded.
+        self.onmessage = function(e) {
+            var msg = e.data;
+            if (msg.type === 'bind') {
+                surfaces[msg.ch] = { canvas: msg.canvas, ctx: msg.canvas.getContext('2d'),
+                                     style: msg.style, pending: null };
+                return;
+            }
+            if (msg.type === 'resize') {
+                if (surfaces[msg.ch]) {
+                    surfaces[msg.ch].canvas.width = msg.width;
+                    surfaces[msg.ch].canvas.height = msg.height;
+                }
+                return;
+            }
+            if (msg.type === 'unbind') {
+                delete surfaces[msg.ch];
+                return;
+            }
+            if (surfaces[msg.ch]) {
+                // Keep only the newest frame; draw once per frame
+                surfaces[msg.ch].pending = msg.b64;
+                if (!frameScheduled) {
+                    frameScheduled = true;
+                    nextFrame(drawPending);
+                }
+                return;
+            }
+
+            var out = process(msg.b64, msg.opts);
+            var transfer = [out.data.buffer];
+            if (out.minmax) transfer.push(out.minmax.buffer);
+            if (out.path) transfer.push(out.path.buffer);
+            self.postMessage({ ch: msg.ch, data: out.data, minmax: out.minmax, path: out.path },
+                             transfer);
+        };
+
+        self.postMessage({ type: 'ready' });
+    } else if (self.clasp) {
+        self.clasp.decode = api;
+    } else {
+        self.claspDecode = api;
+    }
+
+})(this);
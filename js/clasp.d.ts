@@ -4,72 +4,346 @@
 
 declare namespace clasp {
     type ParamChangeHandler = (id: number, value: number) => void;
+    type ParamValueHandler = (value: number, id: number) => void;
+    type ParamsChangedHandler = (ids: number[]) => void;
     type ParamsSyncHandler = (params: Array<{ id: number; v: number }>) => void;
     type NoteOnHandler = (channel: number, key: number, velocity: number) => void;
     type NoteOffHandler = (channel: number, key: number) => void;
     type MidiCCHandler = (channel: number, cc: number, value: number) => void;
     type ReadyHandler = () => void;
+
+    interface Transport {
+        bpm: number;
+        num: number;
+        den: number;
+        playing: boolean;
+        /** Beat position extrapolated to the time of the call */
+        beat: number;
+    }
+
+    type TransportHandler = (transport: Transport) => void;
+    type TransportTickHandler = (beat: number) => void;
     type GenericHandler = (msg: unknown) => void;
 
     type EventHandler =
         | ParamChangeHandler
+        | ParamsChangedHandler
         | ParamsSyncHandler
         | NoteOnHandler
         | NoteOffHandler
         | MidiCCHandler
         | ReadyHandler
+        | TransportHandler
+        | TransportTickHandler
         | GenericHandler;
 
-    type DragMoveHandler = (x: number, y: number, dx: number, dy: number) => void;
+    /** value is the tracked 0..1 value when DragOptions.value is set, otherwise null */
+    type DragMoveHandler = (x: number, y: number, dx: number, dy: number, value: number | null) => void;
+
+    interface DragOptions {
+        /** Param being edited; wraps the drag in a gesture */
+        paramId?: number;
+        /** Start value (0..1); enables value tracking and clasp.setParam() sends */
+        value?: number;
+        /** Value change per pixel (default 0.005) */
+        sensitivity?: number;
+        /** Delta multiplier while shift is held (default 0.1) */
+        fine?: number;
+        /** Extra gain per px/ms of pointer speed (default 0) */
+        acceleration?: number;
+        /** Upper limit for the velocity gain (default 4) */
+        maxGain?: number;
+        /** Drag axis: 'y' (up increases, default), 'x' or 'both' */
+        axis?: 'x' | 'y' | 'both';
+        /** Request pointer lock for unbounded drags (default false) */
+        pointerLock?: boolean;
+    }
     type DragEndHandler = () => void;
 
     /**
      * Subscribe to an event from C++
      */
     function on(event: 'paramChange', handler: ParamChangeHandler): void;
+    function on(event: 'paramsChanged', handler: ParamsChangedHandler): void;
     function on(event: 'paramsSync', handler: ParamsSyncHandler): void;
     function on(event: 'noteOn', handler: NoteOnHandler): void;
     function on(event: 'noteOff', handler: NoteOffHandler): void;
     function on(event: 'midiCC', handler: MidiCCHandler): void;
     function on(event: 'ready', handler: ReadyHandler): void;
+    function on(event: 'transport', handler: TransportHandler): void;
+    function on(event: 'transportTick', handler: TransportTickHandler): void;
+    function on(event: `param:${number}`, handler: ParamValueHandler): void;
     function on(event: string, handler: GenericHandler): void;
 
     /**
      * Remove an event handler
      */
-    function off(event: string, handler: EventHandler): void;
+    function off(event: string, handler: EventHandler | ParamValueHandler): void;
+
+    /**
+     * Subscribe to changes of a single parameter (same as on('param:<id>'))
+     * Returns a function that unsubscribes
+     */
+    function onParam(id: number, handler: ParamValueHandler): () => void;
+
+    /**
+     * Remove a per-parameter handler
+     */
+    function offParam(id: number, handler: ParamValueHandler): void;
+
+    type SmoothingMode = 'none' | 'interpolate' | 'ballistic';
+
+    interface SmoothingOptions {
+        /** interpolate: ramp time in ms (default: observed update interval) */
+        duration?: number;
+        /** ballistic: rise time constant in ms (default 10) */
+        attack?: number;
+        /** ballistic: fall time constant in ms (default 300) */
+        release?: number;
+    }
+
+    /**
+     * Smooth displayed values of a param group between sparse updates
+     * Pass null as ids to set the default for all params
+     */
+    function setSmoothing(ids: number | number[] | null, mode: SmoothingMode, options?: SmoothingOptions): void;
+
+    /**
+     * Current host transport, with the beat position extrapolated to now
+     */
+    function getTransport(): Transport;
+
+    /**
+     * Extrapolated beat position at a performance.now() time (default: now)
+     */
+    function getBeatPosition(now?: number): number;
+
+    interface DataFrame {
+        data: Float32Array;
+        /** (min, max) pairs per bucket when decimation is enabled */
+        minmax: Float32Array | null;
+        /** (x, y) points when a path is requested */
+        path: Float32Array | null;
+    }
+
+    interface DataOptions {
+        decimate?: number;
+        path?: { width: number; height: number; min?: number; max?: number; logX?: boolean };
+    }
+
+    type DataHandler = (data: Float32Array, frame: DataFrame) => void;
+
+    /**
+     * Subscribe to a data channel sent with Protocol::sendData()
+     * Returns a function that unsubscribes
+     */
+    function onData(channel: string, handler: DataHandler): () => void;
+
+    /**
+     * Subscribe to a data channel without decoding (handler gets the base64 string)
+     */
+    function onRawData(channel: string, handler: (base64: string, channel: string) => void): () => void;
+
+    /**
+     * Set decode options (decimation, display path) for a data channel
+     */
+    function setDataOptions(channel: string, opts: DataOptions): void;
+
+    /**
+     * Decode the given data channels in a Web Worker (clasp-worker.js)
+     * url defaults to clasp-worker.js next to clasp.js, or next to the page
+     * when clasp.js was injected by clasp::Protocol. Pass it for pages without
+     * a URL (loadHtml()); otherwise the channels are decoded on the main thread.
+     */
+    function useWorker(channels: string[], url?: string): void;
+
+    /**
+     * Read the latest value of a parameter from the local mirror
+     */
+    function getParam(id: number): number | undefined;
+
+    /**
+     * Message format version; must match clasp::Protocol::PROTOCOL_VERSION
+     */
+    const protocolVersion: number;
+
+    /**
+     * True once the DOM has loaded and 'ready' was emitted
+     */
+    function isLoaded(): boolean;
+
+    /**
+     * Startup timeline recorded by the WebView, in milliseconds since
+     * create(); phases not reached yet are missing
+     */
+    function timings(): Partial<Record<
+        'create' | 'created' | 'setParent' | 'embedded' | 'navigate' |
+        'domContentLoaded' | 'firstFrame' | 'ready' | 'readyApplied', number>>;
 
     /**
      * Call a C++ function registered via Protocol::onCall()
      * Returns a Promise that resolves with the result
+     * Results of cacheable functions are memoized per argument list and
+     * shared between callers, so treat them as read-only
      */
     function call<T = unknown>(name: string, ...args: unknown[]): Promise<T>;
 
+    /**
+     * Drop memoized call results, for one function or all of them
+     */
+    function clearCache(name?: string): void;
+
     /**
      * Send a message to C++ (fire-and-forget)
      */
     function send(type: string, payload?: unknown): void;
 
+    type BatchMode = 'microtask' | 'frame' | 'none';
+
+    /**
+     * Choose how outgoing messages are batched into native crossings
+     * 'microtask' (default) flushes once per microtask, 'frame' once per animation frame
+     */
+    function setBatchMode(mode: BatchMode): void;
+
+    /**
+     * Send any queued outgoing messages now
+     */
+    function flush(): void;
+
+    /**
+     * Set a parameter from the UI (fast path, no reply)
+     */
+    function setParam(id: number, value: number): void;
+
+    /**
+     * Set several parameters in one crossing
+     */
+    function setParams(params: Array<{ id: number; v: number }>): void;
+
+    /**
+     * Tell C++ the UI started editing a parameter (suppresses echoes)
+     */
+    function beginGesture(paramId: number): void;
+
+    /**
+     * Tell C++ the UI finished editing a parameter
+     */
+    function endGesture(paramId: number): void;
+
     /**
      * Start a drag operation (avoids pointer capture banner)
+     * Movement is coalesced and delivered at most once per animation frame
      */
-    function startDrag(onMove: DragMoveHandler, onEnd?: DragEndHandler): void;
+    function startDrag(onMove: DragMoveHandler, onEnd?: DragEndHandler, options?: number | DragOptions): void;
 
     /**
      * End the current drag operation
      */
     function endDrag(): void;
 
+    type Formatter = (value: number, element: Element) => string | number;
+
+    /**
+     * Bind elements carrying data-clasp-param to parameter values
+     * Attributes: data-clasp-param, data-clasp-bind, data-clasp-format,
+     * data-clasp-min, data-clasp-max
+     */
+    function bindParams(root?: Element): void;
+
+    /**
+     * Register a formatter for data-clasp-format="name"
+     */
+    function registerFormatter(name: string, fn: Formatter): void;
+
     /**
      * Disable the browser context menu
      */
     function disableContextMenu(): void;
+
+    /**
+     * Scope/meter renderer for data channels (requires clasp-scope.js)
+     */
+    namespace scope {
+        interface Style {
+            type?: 'scope' | 'spectrum' | 'meter';
+            color?: string;
+            background?: string;
+            lineWidth?: number;
+            min?: number;
+            max?: number;
+            decimate?: number;
+            logX?: boolean;
+        }
+
+        interface Options {
+            workerUrl?: string;
+            forceMainThread?: boolean;
+        }
+
+        interface Handle {
+            /** True if drawing runs in a worker via OffscreenCanvas */
+            offscreen: boolean;
+            resize(width: number, height: number): void;
+            unbind(): void;
+        }
+
+        function bind(canvas: HTMLCanvasElement, channel: string, style?: Style, options?: Options): Handle | null;
+        function unbind(channel: string): void;
+    }
+
+    /**
+     * Canvas widget renderer (requires clasp-widgets.js)
+     */
+    namespace widgets {
+        type WidgetType = 'knob' | 'slider' | 'meter' | 'led' | string;
+
+        interface Widget {
+            type: WidgetType;
+            param: number;
+            x: number;
+            y: number;
+            w: number;
+            h: number;
+            color?: string;
+        }
+
+        interface Theme {
+            background: string;
+            track: string;
+            fill: string;
+            pointer: string;
+            ledOn: string;
+            ledOff: string;
+        }
+
+        interface SurfaceOptions {
+            theme?: Partial<Theme>;
+            dragSensitivity?: number;
+        }
+
+        interface Surface {
+            add(widget: Widget): Widget;
+            remove(widget: Widget): void;
+            hitTest(x: number, y: number): Widget | null;
+            invalidate(widget: Widget): void;
+            redrawAll(): void;
+            resize(): void;
+            destroy(): void;
+        }
+
+        type Painter = (ctx: CanvasRenderingContext2D, widget: Widget, value: number, theme: Theme) => void;
+
+        function createSurface(canvas: HTMLCanvasElement, options?: SurfaceOptions): Surface;
+        function registerPainter(type: string, fn: Painter): void;
+    }
 }
 
 declare global {
     interface Window {
         clasp: typeof clasp;
         __clasp_recv: (json: string) => void;
+        __clasp_data: (channel: string, base64: string) => void;
     }
 }
 
@@ -1,100 +1,1049 @@
 /**
  * clasp.js - Plugin-side JavaScript library for clasp-gui
- * Include this in your plugin's HTML to communicate with C++ via clasp::Protocol
+ * clasp::Protocol injects an embedded copy before the page loads; including
+ * this file with <script src> as well is harmless
  */
 (function() {
     'use strict';
 
-    // Event handlers registry
+    // Message format version; must match clasp::Protocol::PROTOCOL_VERSION
+    var PROTOCOL_VERSION = 1;
+
+    // Already injected by clasp::Protocol - keep that instance and its state
+    if (window.clasp && window.clasp.protocolVersion === PROTOCOL_VERSION) return;
+
+    // Event handlers registry (event name -> Set of handlers)
     var handlers = {};
 
+    // Per-parameter listeners (param id -> Set of handlers)
+    var paramListeners = [];
+
+    // Set once the DOM has loaded
+    var pageLoaded = false;
+
+    // Startup timeline from C++ (phase -> ms since WebView::create)
+    var startupTimings = {};
+
     // Call ID counter for request/response correlation
     var callId = 0;
     var pendingCalls = {};
 
-    // Drag state
+    // Memoized results of cacheable calls (fn -> args JSON -> result), calls in
+    // flight (fn -> args JSON -> { id, promise }) and an invalidation counter
+    var cacheableFns = {};
+    var callCache = {};
+    var inflightCalls = {};
+    var cacheGeneration = 0;
+
+    // Drag state: movement is accumulated per event and delivered once per frame
     var dragState = {
         active: false,
         onMove: null,
-        onEnd: null
+        onEnd: null,
+        paramId: null,
+        options: null,
+        value: null,
+        x: 0,
+        y: 0,
+        accX: 0,
+        accY: 0,
+        lastTime: 0,
+        locked: false,
+        frameScheduled: false
+    };
+
+    var dragDefaults = {
+        paramId: null,
+        value: undefined,     // Start value (0..1); enables built-in value tracking
+        sensitivity: 0.005,   // Value change per pixel
+        fine: 0.1,            // Delta multiplier while shift is held
+        acceleration: 0,      // Extra gain per px/ms of pointer speed
+        maxGain: 4,           // Upper limit for the velocity gain
+        axis: 'y',            // 'y' (up increases), 'x' or 'both'
+        pointerLock: false    // Request pointer lock (may show a browser banner)
+    };
+
+    // Last pointer position, so startDrag() knows where the drag began
+    var pointerPos = { x: 0, y: 0 };
+
+    // Parameter mirror: latest value per id, plus ids changed since last frame
+    // CLAP ids are arbitrary uint32, so each id gets a dense slot (id -> slot)
+    // in the typed arrays instead of indexing them by id
+    var paramSlots = new Map();
+    var paramValues = new Float32Array(256);
+    var paramKnown = new Uint8Array(256);
+    var paramDirty = new Uint8Array(256);
+    var dirtyIds = [];
+    var paramFlushScheduled = false;
+
+    // Display smoothing: id -> config, id -> animation state, ids animating
+    var smoothConfig = [];
+    var defaultSmoothing = null;
+    var smoothState = [];
+    var smoothActive = [];
+
+    // Host transport: last anchor from C++ on the performance.now() clock
+    var transport = {
+        bpm: 120,
+        num: 4,
+        den: 4,
+        playing: false,
+        beat: 0,
+        anchorTime: 0
     };
+    var transportTicking = false;
+
+    // Data channels (Protocol::sendData): channel -> Set of handlers / options
+    var dataHandlers = {};
+    var rawDataHandlers = {};
+    var dataOptions = {};
+    var dataWorker = null;
+    var workerChannels = {};
+    // Directory of this script, or null for the copy injected by
+    // clasp::Protocol, which has no script element
+    var scriptBase = (document.currentScript && document.currentScript.src)
+        ? document.currentScript.src.replace(/[^\/]*$/, '') : null;
+
+    // Internal: default clasp-worker.js URL, next to clasp.js or else next to
+    // the page; null if the page has no hierarchical URL (loadHtml, about:blank)
+    function defaultWorkerUrl() {
+        if (scriptBase !== null) return scriptBase + 'clasp-worker.js';
+        var page = (document.baseURI || (window.location && location.href) || '').replace(/[?#].*$/, '');
+        if (!/^[a-z][a-z0-9+.-]*:\/\//i.test(page)) return null;
+        return page.replace(/[^\/]*$/, '') + 'clasp-worker.js';
+    }
+
+    // DOM bindings: param id -> Set of bindings, element -> binding
+    var paramBindings = [];
+    var elementBindings = new WeakMap();
+    var formatters = {};
+    var bindingObserver = null;
+    var pendingBindings = [];
+    var bindingFlushScheduled = false;
+
+    // Outgoing message batching: 'microtask' (default), 'frame' or 'none'
+    var batchMode = 'microtask';
+    var outQueue = [];
+    var flushScheduled = false;
+    var queuedSets = {};  // param id -> index of its single-value 'set' in outQueue
+
+    // Internal: send all queued messages in a single __clasp crossing
+    function flushOutgoing() {
+        flushScheduled = false;
+        if (!outQueue.length) return;
+        var batch = outQueue;
+        outQueue = [];
+        queuedSets = {};
+        if (typeof __clasp === 'function') {
+            crossToNative(batch);
+        }
+    }
+
+    // Internal: pass messages to the __clasp binding in one crossing
+    // A Protocol answers every crossing with {}; a null answer means none is
+    // attached (a pooled page still loading, or its bindings were cleared),
+    // so the calls in it would never get a reply
+    function crossToNative(msgs) {
+        var result = __clasp(JSON.stringify(msgs.length === 1 ? msgs[0] : msgs));
+        if (!result || typeof result.then !== 'function') return;
+        result.then(function(answer) {
+            if (answer !== null && answer !== undefined) return;
+            for (var i = 0; i < msgs.length; i++) {
+                if (msgs[i].t === 'call') {
+                    rejectCall(msgs[i].id, 'clasp: no Protocol attached to this view');
+                }
+            }
+        });
+    }
+
+    // Internal: fail a pending call that will get no reply
+    function rejectCall(id, message) {
+        var pending = pendingCalls[id];
+        if (!pending) return;
+        delete pendingCalls[id];
+        var inflight = inflightCalls[pending.fn];
+        if (inflight && inflight[pending.key] && inflight[pending.key].id === id) {
+            delete inflight[pending.key];
+        }
+        pending.reject(new Error(message));
+    }
+
+    // Internal: queue a message for C++, returns false if the binding is missing
+    function post(msg) {
+        if (typeof __clasp !== 'function') return false;
+        if (batchMode === 'none') {
+            crossToNative([msg]);
+            return true;
+        }
+        outQueue.push(msg);
+        if (!flushScheduled) {
+            flushScheduled = true;
+            if (batchMode === 'frame' && typeof requestAnimationFrame === 'function') {
+                requestAnimationFrame(flushOutgoing);
+            } else {
+                Promise.resolve().then(flushOutgoing);
+            }
+        }
+        return true;
+    }
+
+    // Internal: schedule a callback for the next display frame
+    function nextFrame(fn) {
+        if (typeof requestAnimationFrame === 'function') {
+            requestAnimationFrame(fn);
+        } else {
+            setTimeout(fn, 16);
+        }
+    }
+
+    // Internal: slot of a param id in the mirror, allocated on first use
+    function paramSlot(id) {
+        var slot = paramSlots.get(id);
+        if (slot !== undefined) return slot;
+
+        slot = paramSlots.size;
+        if (slot >= paramValues.length) {
+            var size = paramValues.length * 2;
+            var values = new Float32Array(size);
+            var known = new Uint8Array(size);
+            var dirty = new Uint8Array(size);
+            values.set(paramValues);
+            known.set(paramKnown);
+            dirty.set(paramDirty);
+            paramValues = values;
+            paramKnown = known;
+            paramDirty = dirty;
+        }
+        paramSlots.set(id, slot);
+        return slot;
+    }
+
+    // Internal: mirrored value of a param, undefined if none was received
+    function readParam(id) {
+        var slot = paramSlots.get(id);
+        return slot !== undefined && paramKnown[slot] ? paramValues[slot] : undefined;
+    }
+
+    // Internal: write an incoming value, smoothing it if configured
+    function writeParam(id, value) {
+        if (typeof id !== 'number' || (id >>> 0) !== id) return;
+
+        var cfg = smoothConfig[id] || defaultSmoothing;
+        if (cfg && cfg.mode !== 'none' && readParam(id) !== undefined) {
+            setSmoothTarget(id, value, cfg);
+            return;
+        }
+        if (smoothState[id]) {
+            smoothState[id].to = value;
+            smoothState[id].done = true;
+        }
+        writeMirror(id, value);
+    }
+
+    // Internal: write a display value into the mirror and mark it dirty
+    function writeMirror(id, value) {
+        var slot = paramSlot(id);
+        paramValues[slot] = value;
+        paramKnown[slot] = 1;
+        if (!paramDirty[slot]) {
+            paramDirty[slot] = 1;
+            dirtyIds.push(id);
+        }
+        if (!paramFlushScheduled) {
+            paramFlushScheduled = true;
+            nextFrame(flushParams);
+        }
+    }
+
+    // Internal: record a new target value with its arrival time
+    function setSmoothTarget(id, value, cfg) {
+        var now = performance.now();
+        var st = smoothState[id];
+        if (!st) {
+            st = smoothState[id] = { from: 0, to: 0, t0: now, last: now, duration: 0, done: true };
+        }
+
+        // Interpolate over the observed update interval unless a duration is given
+        var interval = now - st.last;
+        st.duration = cfg.duration || Math.min(250, Math.max(8, interval));
+        st.last = now;
+        st.from = readParam(id);
+        st.to = value;
+        st.t0 = now;
+
+        if (st.done) {
+            st.done = false;
+            smoothActive.push(id);
+        }
+        if (!paramFlushScheduled) {
+            paramFlushScheduled = true;
+            nextFrame(flushParams);
+        }
+    }
+
+    // Internal: advance smoothed params to the current frame time
+    function stepSmoothing(now) {
+        if (!smoothActive.length) return;
+        var active = smoothActive;
+        smoothActive = [];
+
+        for (var i = 0; i < active.length; i++) {
+            var id = active[i];
+            var st = smoothState[id];
+            if (st.done) continue;
+
+            var cfg = smoothConfig[id] || defaultSmoothing || { mode: 'interpolate' };
+            var current = readParam(id);
+            var next;
+
+            if (cfg.mode === 'ballistic') {
+                // One-pole follower: fast attack, slow release (meters)
+                var dt = Math.max(0, now - (st.frame || st.t0));
+                var tau = st.to > current ? (cfg.attack || 10) : (cfg.release || 300);
+                next = current + (st.to - current) * (1 - Math.exp(-dt / tau));
+                if (Math.abs(st.to - next) < 1e-4) next = st.to;
+                st.frame = now;
+            } else {
+                var t = st.duration > 0 ? (now - st.t0) / st.duration : 1;
+                next = t >= 1 ? st.to : st.from + (st.to - st.from) * t;
+            }
+
+            if (next !== current) {
+                writeMirror(id, next);
+            }
+            if (next === st.to) {
+                st.done = true;
+                st.frame = 0;
+            } else {
+                smoothActive.push(id);
+                if (!paramFlushScheduled) {
+                    paramFlushScheduled = true;
+                    nextFrame(flushParams);
+                }
+            }
+        }
+    }
+
+    // Internal: notify subscribers once per frame with the changed ids
+    function flushParams(now) {
+        paramFlushScheduled = false;
+        stepSmoothing(typeof now === 'number' ? now : performance.now());
+        if (!dirtyIds.length) return;
+        var ids = dirtyIds;
+        dirtyIds = [];
+        for (var i = 0; i < ids.length; i++) {
+            paramDirty[paramSlots.get(ids[i])] = 0;
+        }
+
+        // DOM writes first, so handlers that read layout see the final state
+        for (var k = 0; k < ids.length; k++) {
+            if (paramBindings[ids[k]]) {
+                applyBindings(ids[k], readParam(ids[k]));
+            }
+        }
+
+        emit('paramsChanged', [ids]);
+
+        var broadcast = handlers.paramChange && handlers.paramChange.size > 0;
+        for (var j = 0; j < ids.length; j++) {
+            var id = ids[j];
+            var value = readParam(id);
+            if (paramListeners[id]) {
+                emitParam(id, value);
+            }
+            if (broadcast) {
+                emit('paramChange', [id, value]);
+            }
+        }
+    }
+
+    // Internal: notify the listeners of a single param
+    function emitParam(id, value) {
+        paramListeners[id].forEach(function(handler) {
+            try {
+                handler(value, id);
+            } catch (e) {
+                console.error('clasp: error in param', id, 'handler:', e);
+            }
+        });
+    }
+
+    // Internal: parse 'param:<id>' event names, returns -1 for other events
+    function paramTopic(event) {
+        if (typeof event !== 'string' || event.lastIndexOf('param:', 0) !== 0) return -1;
+        var id = parseInt(event.substring(6), 10);
+        return isNaN(id) ? -1 : id;
+    }
+
+    // Internal: number attribute with a default
+    function numAttr(el, name, fallback) {
+        var v = parseFloat(el.getAttribute(name));
+        return isNaN(v) ? fallback : v;
+    }
+
+    // Internal: create a binding from an element's data-clasp-* attributes
+    // data-clasp-param="42"       param id
+    // data-clasp-bind="rotate"    text (default), value, rotate, opacity, scaleX,
+    //                             scaleY, translateX, translateY, style:<prop>, attr:<name>
+    // data-clasp-format="name"    formatter registered via clasp.registerFormatter()
+    // data-clasp-min/max          output range for rotate/opacity/scale/translate
+    function createBinding(el) {
+        var id = parseInt(el.getAttribute('data-clasp-param'), 10);
+        if (isNaN(id) || id < 0) return null;
+
+        var mode = el.getAttribute('data-clasp-bind') || 'text';
+        var defaults = {
+            rotate: [-135, 135],
+            opacity: [0, 1],
+            scaleX: [0, 1],
+            scaleY: [0, 1],
+            translateX: [0, 100],
+            translateY: [0, 100]
+        }[mode] || [0, 1];
+
+        return {
+            el: el,
+            id: id,
+            mode: mode,
+            format: el.getAttribute('data-clasp-format'),
+            min: numAttr(el, 'data-clasp-min', defaults[0]),
+            max: numAttr(el, 'data-clasp-max', defaults[1]),
+            last: null
+        };
+    }
+
+    // Internal: write a value to one bound element (no layout reads)
+    function writeBinding(b, value) {
+        var mapped = b.min + value * (b.max - b.min);
+        var out;
+        switch (b.mode) {
+            case 'rotate':     out = 'rotate(' + mapped + 'deg)'; break;
+            case 'scaleX':     out = 'scaleX(' + mapped + ')'; break;
+            case 'scaleY':     out = 'scaleY(' + mapped + ')'; break;
+            case 'translateX': out = 'translateX(' + mapped + 'px)'; break;
+            case 'translateY': out = 'translateY(' + mapped + 'px)'; break;
+            case 'opacity':    out = String(mapped); break;
+            default:
+                var fmt = b.format && formatters[b.format];
+                out = fmt ? String(fmt(value, b.el)) : String(Math.round(value * 100) / 100);
+        }
+
+        if (out === b.last) return;
+        b.last = out;
+
+        if (b.mode === 'text') {
+            b.el.textContent = out;
+        } else if (b.mode === 'value') {
+            b.el.value = out;
+        } else if (b.mode === 'opacity') {
+            b.el.style.opacity = out;
+        } else if (b.mode.lastIndexOf('style:', 0) === 0) {
+            b.el.style.setProperty(b.mode.substring(6), out);
+        } else if (b.mode.lastIndexOf('attr:', 0) === 0) {
+            b.el.setAttribute(b.mode.substring(5), out);
+        } else {
+            b.el.style.transform = out;
+        }
+    }
+
+    // Internal: update all elements bound to a param
+    function applyBindings(id, value) {
+        paramBindings[id].forEach(function(b) {
+            try {
+                writeBinding(b, value);
+            } catch (e) {
+                console.error('clasp: error in binding for param', id, ':', e);
+            }
+        });
+    }
+
+    // Internal: write initial values for new bindings in the next frame
+    function flushPendingBindings() {
+        bindingFlushScheduled = false;
+        var list = pendingBindings;
+        pendingBindings = [];
+        for (var i = 0; i < list.length; i++) {
+            var b = list[i];
+            var value = readParam(b.id);
+            if (elementBindings.get(b.el) === b && value !== undefined) {
+                writeBinding(b, value);
+            }
+        }
+    }
+
+    function bindElement(el) {
+        unbindElement(el);
+        var b = createBinding(el);
+        if (!b) return;
+        elementBindings.set(el, b);
+        if (!paramBindings[b.id]) {
+            paramBindings[b.id] = new Set();
+        }
+        paramBindings[b.id].add(b);
+
+        if (readParam(b.id) !== undefined) {
+            pendingBindings.push(b);
+            if (!bindingFlushScheduled) {
+                bindingFlushScheduled = true;
+                nextFrame(flushPendingBindings);
+            }
+        }
+    }
+
+    function unbindElement(el) {
+        var b = elementBindings.get(el);
+        if (!b) return;
+        elementBindings.delete(el);
+        var set = paramBindings[b.id];
+        if (set) {
+            set.delete(b);
+            if (set.size === 0) paramBindings[b.id] = undefined;
+        }
+    }
+
+    // Internal: apply fn to node and all descendants carrying data-clasp-param
+    function forEachBound(node, fn) {
+        if (node.nodeType !== 1) return;
+        if (node.hasAttribute('data-clasp-param')) fn(node);
+        var list = node.querySelectorAll('[data-clasp-param]');
+        for (var i = 0; i < list.length; i++) fn(list[i]);
+    }
+
+    // Internal: keep bindings in sync with DOM changes
+    function onBindingMutations(mutations) {
+        for (var i = 0; i < mutations.length; i++) {
+            var m = mutations[i];
+            if (m.type === 'attributes') {
+                if (m.target.hasAttribute('data-clasp-param')) {
+                    bindElement(m.target);
+                } else {
+                    unbindElement(m.target);
+                }
+                continue;
+            }
+            for (var r = 0; r < m.removedNodes.length; r++) {
+                forEachBound(m.removedNodes[r], unbindElement);
+            }
+            for (var a = 0; a < m.addedNodes.length; a++) {
+                forEachBound(m.addedNodes[a], bindElement);
+            }
+        }
+    }
+
+    // Internal: extrapolated beat position at a performance.now() time
+    function beatAt(now) {
+        if (!transport.playing) return transport.beat;
+        return transport.beat + (now - transport.anchorTime) * transport.bpm / 60000;
+    }
+
+    // Internal: per-frame transportTick while playing and subscribed
+    function transportFrame(now) {
+        if (!transport.playing || !handlers.transportTick || !handlers.transportTick.size) {
+            transportTicking = false;
+            return;
+        }
+        emit('transportTick', [beatAt(typeof now === 'number' ? now : performance.now())]);
+        nextFrame(transportFrame);
+    }
+
+    function startTransportTicks() {
+        if (!transportTicking && transport.playing) {
+            transportTicking = true;
+            nextFrame(transportFrame);
+        }
+    }
+
+    // Internal: decode base64 float32 on the main thread (no worker)
+    function decodeData(b64, opts) {
+        if (clasp.decode) {
+            return clasp.decode.process(b64, opts);
+        }
+        var bin = atob(b64);
+        var bytes = new Uint8Array(bin.length);
+        for (var i = 0; i < bin.length; i++) {
+            bytes[i] = bin.charCodeAt(i);
+        }
+        return { data: new Float32Array(bytes.buffer, 0, bytes.length >> 2), minmax: null, path: null };
+    }
+
+    // Internal: hand a decoded frame to the channel's handlers
+    function deliverData(ch, frame) {
+        var set = dataHandlers[ch];
+        if (!set) return;
+        set.forEach(function(handler) {
+            try {
+                handler(frame.data, frame);
+            } catch (e) {
+                console.error('clasp: error in data handler for', ch, ':', e);
+            }
+        });
+    }
+
+    // Internal: forget memoized results for the named functions (null = all)
+    function invalidateCalls(names) {
+        cacheGeneration++;
+        if (!names) {
+            callCache = {};
+            inflightCalls = {};
+            return;
+        }
+        for (var i = 0; i < names.length; i++) {
+            delete callCache[names[i]];
+            // Later identical calls must not join a request that may be stale
+            delete inflightCalls[names[i]];
+        }
+    }
+
+    // Internal: notify C++ that a param gesture started/ended
+    function sendGesture(paramId, on) {
+        // Later sets must not be merged across the gesture marker
+        delete queuedSets[paramId];
+        post({ t: 'gesture', id: paramId, on: on });
+    }
+
+    // Internal: accumulate pointer movement, applying fine-adjust and velocity gain
+    function onDragMove(e) {
+        if (!dragState.active) return;
+        var opts = dragState.options;
+        var events = (e.getCoalescedEvents && e.getCoalescedEvents()) || [];
+        if (!events.length) events = [e];
+
+        for (var i = 0; i < events.length; i++) {
+            var ev = events[i];
+            var dx, dy;
+            if (dragState.locked) {
+                dx = ev.movementX || 0;
+                dy = ev.movementY || 0;
+            } else {
+                // clientX/Y can be fractional, unlike movementX/Y
+                dx = ev.clientX - dragState.x;
+                dy = ev.clientY - dragState.y;
+            }
+            dragState.x += dx;
+            dragState.y += dy;
+
+            var gain = ev.shiftKey ? opts.fine : 1;
+            if (opts.acceleration) {
+                var dt = Math.max(1, ev.timeStamp - dragState.lastTime);
+                var speed = Math.sqrt(dx * dx + dy * dy) / dt;
+                gain *= Math.min(opts.maxGain, 1 + opts.acceleration * speed);
+            }
+            dragState.lastTime = ev.timeStamp;
+            dragState.accX += dx * gain;
+            dragState.accY += dy * gain;
+        }
+
+        if (!dragState.frameScheduled) {
+            dragState.frameScheduled = true;
+            nextFrame(deliverDrag);
+        }
+    }
+
+    // Internal: deliver accumulated movement (at most once per frame)
+    function deliverDrag() {
+        dragState.frameScheduled = false;
+        if (!dragState.active) return;
+        var dx = dragState.accX;
+        var dy = dragState.accY;
+        if (!dx && !dy) return;
+        dragState.accX = 0;
+        dragState.accY = 0;
+
+        var opts = dragState.options;
+        if (dragState.value !== null) {
+            var delta = opts.axis === 'x' ? dx : (opts.axis === 'both' ? dx - dy : -dy);
+            var v = Math.min(1, Math.max(0, dragState.value + delta * opts.sensitivity));
+            if (v !== dragState.value) {
+                dragState.value = v;
+                if (dragState.paramId !== null) {
+                    clasp.setParam(dragState.paramId, v);
+                }
+            }
+        }
+
+        if (dragState.onMove) {
+            dragState.onMove(dragState.x, dragState.y, dx, dy, dragState.value);
+        }
+    }
 
     // The clasp object
     var clasp = {
+        protocolVersion: PROTOCOL_VERSION,
+
         /**
          * Subscribe to an event from C++
-         * Events: paramChange, paramsSync, noteOn, noteOff, midiCC, ready
+         * Events: paramChange, paramsChanged, paramsSync, noteOn, noteOff, midiCC,
+         *         transport, transportTick, ready
+         * paramChange and paramsChanged fire at most once per id per animation frame
          */
         on: function(event, handler) {
+            var id = paramTopic(event);
+            if (id >= 0) {
+                clasp.onParam(id, handler);
+                return;
+            }
             if (!handlers[event]) {
-                handlers[event] = [];
+                handlers[event] = new Set();
+            }
+            handlers[event].add(handler);
+            if (event === 'transportTick') {
+                startTransportTicks();
             }
-            handlers[event].push(handler);
         },
 
         /**
          * Remove an event handler
          */
         off: function(event, handler) {
-            if (!handlers[event]) return;
-            var idx = handlers[event].indexOf(handler);
-            if (idx !== -1) {
-                handlers[event].splice(idx, 1);
+            var id = paramTopic(event);
+            if (id >= 0) {
+                clasp.offParam(id, handler);
+                return;
+            }
+            if (handlers[event]) {
+                handlers[event].delete(handler);
+            }
+        },
+
+        /**
+         * Subscribe to changes of a single parameter (same as on('param:<id>'))
+         * Handler is called with (value, id), at most once per animation frame
+         * Returns a function that unsubscribes
+         */
+        onParam: function(id, handler) {
+            if (!paramListeners[id]) {
+                paramListeners[id] = new Set();
+            }
+            paramListeners[id].add(handler);
+            return function() {
+                clasp.offParam(id, handler);
+            };
+        },
+
+        /**
+         * Remove a per-parameter handler
+         */
+        offParam: function(id, handler) {
+            var listeners = paramListeners[id];
+            if (!listeners) return;
+            listeners.delete(handler);
+            if (listeners.size === 0) {
+                paramListeners[id] = undefined;
+            }
+        },
+
+        /**
+         * Smooth displayed values of a param group between sparse updates
+         * @param {number|number[]|null} ids - Param id(s), or null for the default
+         * @param {string} mode - 'none', 'interpolate' or 'ballistic' (meters)
+         * @param {object} [options] - interpolate: { duration } in ms (default:
+         *                             observed update interval); ballistic:
+         *                             { attack, release } time constants in ms
+         */
+        setSmoothing: function(ids, mode, options) {
+            var cfg = Object.assign({ mode: mode }, options);
+            if (ids === null || ids === undefined) {
+                defaultSmoothing = mode === 'none' ? null : cfg;
+                return;
+            }
+            if (typeof ids === 'number') ids = [ids];
+            for (var i = 0; i < ids.length; i++) {
+                smoothConfig[ids[i]] = cfg;
+            }
+        },
+
+        /**
+         * Current host transport, with the beat position extrapolated to now
+         * Returns { bpm, num, den, playing, beat }
+         */
+        getTransport: function() {
+            return {
+                bpm: transport.bpm,
+                num: transport.num,
+                den: transport.den,
+                playing: transport.playing,
+                beat: beatAt(performance.now())
+            };
+        },
+
+        /**
+         * Extrapolated beat position (call from requestAnimationFrame)
+         * @param {number} [now] - performance.now() time, e.g. the rAF timestamp
+         */
+        getBeatPosition: function(now) {
+            return beatAt(typeof now === 'number' ? now : performance.now());
+        },
+
+        /**
+         * Subscribe to a data channel sent with Protocol::sendData()
+         * Handler is called with (Float32Array data, frame) where frame also has
+         * minmax and path when decimation/path options are set
+         * Returns a function that unsubscribes
+         */
+        onData: function(channel, handler) {
+            if (!dataHandlers[channel]) {
+                dataHandlers[channel] = new Set();
+            }
+            dataHandlers[channel].add(handler);
+            return function() {
+                dataHandlers[channel].delete(handler);
+            };
+        },
+
+        /**
+         * Subscribe to a data channel without decoding (handler gets the base64 string)
+         * Used to forward channels to workers; returns a function that unsubscribes
+         */
+        onRawData: function(channel, handler) {
+            if (!rawDataHandlers[channel]) {
+                rawDataHandlers[channel] = new Set();
             }
+            rawDataHandlers[channel].add(handler);
+            return function() {
+                rawDataHandlers[channel].delete(handler);
+            };
+        },
+
+        /**
+         * Set decode options for a data channel
+         * @param {object} opts - { decimate: buckets, path: { width, height, min, max, logX } }
+         */
+        setDataOptions: function(channel, opts) {
+            dataOptions[channel] = opts;
+        },
+
+        /**
+         * Decode the given data channels in a Web Worker (clasp-worker.js)
+         * Falls back to main-thread decoding if Workers are unavailable
+         * @param {string[]} channels - Heavy channels to offload
+         * @param {string} [url] - Worker script URL (default: next to clasp.js,
+         *   or next to the page when clasp.js was injected; required for pages
+         *   without a URL such as loadHtml())
+         */
+        useWorker: function(channels, url) {
+            if (dataWorker || typeof Worker !== 'function') {
+                for (var c = 0; c < channels.length; c++) workerChannels[channels[c]] = true;
+                return;
+            }
+            var workerUrl = url || defaultWorkerUrl();
+            if (!workerUrl) {
+                console.error('clasp: useWorker() needs the clasp-worker.js URL on this page, ' +
+                              'decoding on main thread');
+                return;
+            }
+            for (var i = 0; i < channels.length; i++) {
+                workerChannels[channels[i]] = true;
+            }
+            try {
+                dataWorker = new Worker(workerUrl);
+                dataWorker.onmessage = function(e) {
+                    if (e.data.type === 'ready') return;
+                    deliverData(e.data.ch, e.data);
+                };
+                dataWorker.onerror = function(e) {
+                    console.error('clasp: data worker failed, decoding on main thread:', e.message);
+                    dataWorker = null;
+                };
+            } catch (e) {
+                console.error('clasp: could not start data worker:', e);
+                dataWorker = null;
+            }
+        },
+
+        /**
+         * Read the latest value of a parameter from the local mirror
+         * Returns undefined if no value has been received for this id
+         */
+        getParam: function(id) {
+            return readParam(id);
+        },
+
+        /**
+         * True once the DOM has loaded and 'ready' was emitted
+         */
+        isLoaded: function() {
+            return pageLoaded;
+        },
+
+        /**
+         * Startup timeline recorded by the WebView, in milliseconds since
+         * create(): create, created, setParent, embedded, navigate,
+         * domContentLoaded, firstFrame, ready, readyApplied. Phases not
+         * reached yet are missing.
+         */
+        timings: function() {
+            var copy = {};
+            for (var phase in startupTimings) copy[phase] = startupTimings[phase];
+            return copy;
         },
 
         /**
          * Call a C++ function registered via Protocol::onCall()
          * Returns a Promise that resolves with the result
+         * Cacheable functions (CallOptions::cacheable) are memoized per argument
+         * list, and identical calls in flight share one request
          */
         call: function(name) {
             var args = Array.prototype.slice.call(arguments, 1);
-            var id = ++callId;
+            var key = JSON.stringify(args);
 
-            return new Promise(function(resolve, reject) {
-                pendingCalls[id] = { resolve: resolve, reject: reject };
+            // Functions registered with CallOptions::cacheable are memoized
+            var cached = callCache[name];
+            if (cached && Object.prototype.hasOwnProperty.call(cached, key)) {
+                return Promise.resolve(cached[key]);
+            }
+            var inflight = inflightCalls[name];
+            if (inflight && inflight[key]) {
+                return inflight[key].promise;
+            }
 
-                var msg = JSON.stringify({
+            var id = ++callId;
+            var promise = new Promise(function(resolve, reject) {
+                pendingCalls[id] = { resolve: resolve, reject: reject, fn: name, key: key,
+                                     generation: cacheGeneration };
+
+                var msg = {
                     t: 'call',
                     fn: name,
                     args: args,
                     id: id
-                });
+                };
 
                 // Send via the __clasp binding
-                if (typeof __clasp === 'function') {
-                    __clasp(msg);
-                } else {
+                if (!post(msg)) {
                     reject(new Error('clasp: __clasp binding not available'));
                     delete pendingCalls[id];
                 }
             });
+
+            if (cacheableFns[name] && pendingCalls[id]) {
+                if (!inflightCalls[name]) inflightCalls[name] = {};
+                inflightCalls[name][key] = { id: id, promise: promise };
+            }
+            return promise;
+        },
+
+        /**
+         * Drop memoized call results, for one function or all of them
+         * C++ normally does this via Protocol::invalidateCache()
+         */
+        clearCache: function(name) {
+            invalidateCalls(name === undefined ? null : [name]);
         },
 
         /**
          * Send a message to C++ (fire-and-forget)
          */
         send: function(type, payload) {
-            var msg = JSON.stringify({
+            post({
                 t: 'msg',
                 type: type,
                 payload: payload
             });
+        },
 
-            if (typeof __clasp === 'function') {
-                __clasp(msg);
+        /**
+         * Set a parameter from the UI (fast path, no reply)
+         * Lands in the UI->audio queue drained by Protocol::popParamChange()
+         */
+        setParam: function(id, value) {
+            // Coalesce repeated sets of the same param within one batch
+            var idx = queuedSets[id];
+            if (idx !== undefined) {
+                outQueue[idx].p[1] = value;
+                return;
             }
+            if (post({ t: 'set', p: [id, value] }) && batchMode !== 'none') {
+                queuedSets[id] = outQueue.length - 1;
+            }
+        },
+
+        /**
+         * Set several parameters in one crossing
+         * @param {Array} params - [{id, v}, ...]
+         */
+        setParams: function(params) {
+            var flat = [];
+            for (var i = 0; i < params.length; i++) {
+                flat.push(params[i].id, params[i].v);
+            }
+            if (flat.length) {
+                post({ t: 'set', p: flat });
+            }
+        },
+
+        /**
+         * Choose how outgoing messages are batched into __clasp crossings
+         * @param {string} mode - 'microtask' (default), 'frame' or 'none'
+         */
+        setBatchMode: function(mode) {
+            flushOutgoing();
+            batchMode = mode;
+        },
+
+        /**
+         * Send any queued outgoing messages now
+         */
+        flush: function() {
+            flushOutgoing();
+        },
+
+        /**
+         * Tell C++ the UI started editing a parameter
+         * Echoes of this param are suppressed until endGesture()
+         */
+        beginGesture: function(paramId) {
+            sendGesture(paramId, true);
+        },
+
+        /**
+         * Tell C++ the UI finished editing a parameter
+         * C++ then sends the authoritative value once
+         */
+        endGesture: function(paramId) {
+            sendGesture(paramId, false);
         },
 
         /**
          * Start a drag operation (avoids pointer capture banner)
-         * @param {function} onMove - Called with (x, y, dx, dy) on mouse move
+         * Movement is read from coalesced pointer events with sub-pixel precision
+         * and delivered at most once per animation frame. Holding shift scales
+         * deltas by options.fine.
+         * @param {function} onMove - Called with (x, y, dx, dy, value) once per frame
          * @param {function} onEnd - Called when drag ends
+         * @param {number|object} [options] - Param id, or { paramId, value, sensitivity,
+         *        fine, acceleration, maxGain, axis, pointerLock }. With paramId the drag
+         *        is wrapped in a gesture; with value (0..1) the new value is tracked,
+         *        passed to onMove and sent with clasp.setParam(paramId, value)
          */
-        startDrag: function(onMove, onEnd) {
+        startDrag: function(onMove, onEnd, options) {
+            if (dragState.active) {
+                clasp.endDrag();
+            }
+            if (typeof options === 'number') {
+                options = { paramId: options };
+            }
+            var opts = Object.assign({}, dragDefaults, options);
+
             dragState.active = true;
             dragState.onMove = onMove;
             dragState.onEnd = onEnd;
+            dragState.options = opts;
+            dragState.paramId = (typeof opts.paramId === 'number') ? opts.paramId : null;
+            dragState.value = (typeof opts.value === 'number') ? opts.value : null;
+            dragState.x = pointerPos.x;
+            dragState.y = pointerPos.y;
+            dragState.accX = 0;
+            dragState.accY = 0;
+            dragState.lastTime = (typeof performance !== 'undefined') ? performance.now() : 0;
+            dragState.locked = false;
+
+            if (dragState.paramId !== null) {
+                sendGesture(dragState.paramId, true);
+            }
+            if (opts.pointerLock && document.body.requestPointerLock) {
+                document.body.requestPointerLock();
+            }
             document.body.style.cursor = 'grabbing';
             document.body.style.userSelect = 'none';
         },
@@ -104,17 +1053,62 @@
          */
         endDrag: function() {
             if (dragState.active) {
+                // Deliver any movement still pending for this frame
+                deliverDrag();
+                if (dragState.locked && document.exitPointerLock) {
+                    document.exitPointerLock();
+                }
                 if (dragState.onEnd) {
                     dragState.onEnd();
                 }
+                if (dragState.paramId !== null) {
+                    sendGesture(dragState.paramId, false);
+                }
                 dragState.active = false;
                 dragState.onMove = null;
                 dragState.onEnd = null;
+                dragState.paramId = null;
+                dragState.options = null;
+                dragState.value = null;
+                dragState.locked = false;
                 document.body.style.cursor = '';
                 document.body.style.userSelect = '';
             }
         },
 
+        /**
+         * Bind elements carrying data-clasp-param to parameter values
+         * Scans root once, then follows DOM changes with a MutationObserver.
+         * All writes happen in one animation-frame pass.
+         * @param {Element} [root] - Subtree to bind (default: document.body)
+         */
+        bindParams: function(root) {
+            root = root || document.body;
+            if (bindingObserver) {
+                bindingObserver.disconnect();
+            }
+            forEachBound(root, bindElement);
+
+            if (typeof MutationObserver === 'function') {
+                bindingObserver = new MutationObserver(onBindingMutations);
+                bindingObserver.observe(root, {
+                    childList: true,
+                    subtree: true,
+                    attributes: true,
+                    attributeFilter: ['data-clasp-param', 'data-clasp-bind',
+                                      'data-clasp-format', 'data-clasp-min', 'data-clasp-max']
+                });
+            }
+        },
+
+        /**
+         * Register a formatter for data-clasp-format="name"
+         * @param {function} fn - Called with (value, element), returns display string
+         */
+        registerFormatter: function(name, fn) {
+            formatters[name] = fn;
+        },
+
         /**
          * Disable the browser context menu
          */
@@ -128,13 +1122,13 @@
     // Internal: emit an event to handlers
     function emit(event, args) {
         if (!handlers[event]) return;
-        for (var i = 0; i < handlers[event].length; i++) {
+        handlers[event].forEach(function(handler) {
             try {
-                handlers[event][i].apply(null, args);
+                handler.apply(null, args);
             } catch (e) {
                 console.error('clasp: error in', event, 'handler:', e);
             }
-        }
+        });
     }
 
     // Internal: receive messages from C++
@@ -148,18 +1142,46 @@
             return;
         }
 
+        // A batch of messages (e.g., replies to a batched send)
+        if (Array.isArray(msg)) {
+            for (var i = 0; i < msg.length; i++) {
+                dispatch(msg[i]);
+            }
+        } else {
+            dispatch(msg);
+        }
+    };
+
+    // Internal: receive a data block from C++ (Protocol::sendData)
+    // Skips JSON.parse; heavy channels go straight to the worker
+    window.__clasp_data = function(ch, b64) {
+        if (rawDataHandlers[ch]) {
+            rawDataHandlers[ch].forEach(function(handler) {
+                handler(b64, ch);
+            });
+        }
+        if (!dataHandlers[ch] || !dataHandlers[ch].size) return;
+        if (dataWorker && workerChannels[ch]) {
+            dataWorker.postMessage({ ch: ch, b64: b64, opts: dataOptions[ch] });
+        } else {
+            deliverData(ch, decodeData(b64, dataOptions[ch]));
+        }
+    };
+
+    // Internal: dispatch a single message from C++
+    function dispatch(msg) {
         switch (msg.t) {
             case 'param':
-                emit('paramChange', [msg.id, msg.v]);
+                writeParam(msg.id, msg.v);
                 break;
 
             case 'params':
                 emit('paramsSync', [msg.params]);
-                // Also emit individual paramChange for each
+                // Individual values go through the mirror
                 if (msg.params) {
                     for (var i = 0; i < msg.params.length; i++) {
                         var p = msg.params[i];
-                        emit('paramChange', [p.id, p.v]);
+                        writeParam(p.id, p.v);
                     }
                 }
                 break;
@@ -177,18 +1199,66 @@
                 break;
 
             case 'ready':
+                if (msg.v !== undefined && msg.v !== PROTOCOL_VERSION) {
+                    console.error('clasp: protocol version mismatch (clasp.js ' +
+                                  PROTOCOL_VERSION + ', clasp.hpp ' + msg.v + ')');
+                }
+                if (msg.cacheable) {
+                    for (var c = 0; c < msg.cacheable.length; c++) {
+                        cacheableFns[msg.cacheable[c]] = true;
+                    }
+                }
                 emit('ready', []);
+                post({ t: 'mark', p: 'readyApplied' });
+                break;
+
+            case 'hello':
+                // A Protocol attached after the page loaded (pooled view)
+                post({ t: 'hello', v: PROTOCOL_VERSION });
+                break;
+
+            case 'timings':
+                startupTimings = msg.phases || {};
+                break;
+
+            case 'invalidate':
+                invalidateCalls(msg.all ? null : msg.fns);
+                break;
+
+            case 'transport':
+                // C++ only sends on change or drift; extrapolate in between
+                transport.bpm = msg.bpm;
+                transport.num = msg.num;
+                transport.den = msg.den;
+                transport.playing = msg.playing;
+                transport.beat = msg.beat;
+                transport.anchorTime = performance.now() - (msg.age || 0);
+                emit('transport', [clasp.getTransport()]);
+                startTransportTicks();
                 break;
 
             case 'reply':
                 // Response to a call()
-                if (pendingCalls[msg.id]) {
+                var pending = pendingCalls[msg.id];
+                if (pending) {
                     if (msg.error) {
-                        pendingCalls[msg.id].reject(new Error(msg.error));
-                    } else {
-                        pendingCalls[msg.id].resolve(msg.result);
+                        rejectCall(msg.id, msg.error);
+                        break;
                     }
                     delete pendingCalls[msg.id];
+                    var inflight = inflightCalls[pending.fn];
+                    if (inflight && inflight[pending.key] && inflight[pending.key].id === msg.id) {
+                        delete inflight[pending.key];
+                    }
+                    if (msg.cache) {
+                        cacheableFns[pending.fn] = true;
+                        // Results requested before an invalidation may be stale
+                        if (pending.generation === cacheGeneration) {
+                            if (!callCache[pending.fn]) callCache[pending.fn] = {};
+                            callCache[pending.fn][pending.key] = msg.result;
+                        }
+                    }
+                    pending.resolve(msg.result);
                 }
                 break;
 
@@ -196,29 +1266,57 @@
                 // Unknown message type - emit as generic event
                 emit(msg.t, [msg]);
         }
-    };
+    }
 
-    // Mouse event handlers for drag
-    document.addEventListener('mousemove', function(e) {
-        if (dragState.active && dragState.onMove) {
-            dragState.onMove(e.clientX, e.clientY, e.movementX, e.movementY);
-        }
-    });
+    // Pointer event handlers for drag (mouse events where pointer events are missing)
+    var hasPointerEvents = typeof window.PointerEvent === 'function';
+
+    document.addEventListener(hasPointerEvents ? 'pointerdown' : 'mousedown', function(e) {
+        pointerPos.x = e.clientX;
+        pointerPos.y = e.clientY;
+    }, true);
+
+    document.addEventListener(hasPointerEvents ? 'pointermove' : 'mousemove', onDragMove);
 
-    document.addEventListener('mouseup', function(e) {
+    document.addEventListener(hasPointerEvents ? 'pointerup' : 'mouseup', function(e) {
         clasp.endDrag();
     });
 
+    document.addEventListener('pointerlockchange', function() {
+        dragState.locked = dragState.active && document.pointerLockElement === document.body;
+    });
+
     // Expose globally
     window.clasp = clasp;
 
-    // Signal ready after DOM loaded
+    // Signal ready after DOM loaded; a lazily created GuiHelper waits for
+    // __clasp_loaded before swapping its placeholder for the page
+    function onLoaded() {
+        pageLoaded = true;
+        // Handshake: C++ checks the version via Protocol::isProtocolVersionMatch()
+        post({ t: 'hello', v: PROTOCOL_VERSION });
+        if (typeof window.__clasp_loaded === 'function') {
+            window.__clasp_loaded();
+        }
+        emit('ready', []);
+    }
+
+    // Internal: report page-side startup phases, timed by C++ on arrival
+    function markStartup() {
+        post({ t: 'mark', p: 'domContentLoaded' });
+        if (typeof requestAnimationFrame === 'function') {
+            requestAnimationFrame(function() {
+                post({ t: 'mark', p: 'firstFrame' });
+            });
+        }
+    }
+
     if (document.readyState === 'complete' || document.readyState === 'interactive') {
-        setTimeout(function() { emit('ready', []); }, 0);
+        setTimeout(onLoaded, 0);
+        markStartup();
     } else {
-        document.addEventListener('DOMContentLoaded', function() {
-            emit('ready', []);
-        });
+        document.addEventListener('DOMContentLoaded', onLoaded);
+        document.addEventListener('DOMContentLoaded', markStartup);
     }
 
 })();
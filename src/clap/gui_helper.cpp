@@ -6,12 +6,129 @@ namespace clasp_gui {
 namespace clap {
 
 GuiHelper::GuiHelper() = default;
-GuiHelper::~GuiHelper() = default;
+
+GuiHelper::~GuiHelper() {
+    removePlaceholder();
+    if (parked_) {
+        parkingPool().unpark(webview_);
+        parked_ = false;
+    }
+    if (lease_) {
+        releaseWebView();
+    }
+}
 
 void GuiHelper::setWebView(WebView* webview) {
     webview_ = webview;
 }
 
+void GuiHelper::setWebViewPool(WebViewPool* pool) {
+    pool_ = pool;
+}
+
+void GuiHelper::onWebViewCreated(WebViewCallback callback) {
+    onCreated_ = std::move(callback);
+}
+
+void GuiHelper::onWebViewDestroy(WebViewCallback callback) {
+    onDestroy_ = std::move(callback);
+}
+
+void GuiHelper::setParkOnDestroy(bool park) {
+    parkOnDestroy_ = park;
+}
+
+void GuiHelper::onWebViewParked(WebViewCallback callback) {
+    onParked_ = std::move(callback);
+}
+
+void GuiHelper::onWebViewResumed(WebViewCallback callback) {
+    onResumed_ = std::move(callback);
+}
+
+void GuiHelper::setLazyCreate(bool lazy) {
+    lazy_ = lazy;
+}
+
+void GuiHelper::idle() {
+    if (pending_) {
+        buildWebView();
+    }
+    platform::flushPendingResizes();
+}
+
+void GuiHelper::pageReady() {
+    if (!waitingForPage_ || !webview_) return;
+    waitingForPage_ = false;
+
+    if (parent_.handle) {
+        webview_->setParent(parent_);
+        webview_->setSize(width_, height_);
+    }
+    removePlaceholder();
+    if (visible_) {
+        webview_->show();
+    }
+}
+
+bool GuiHelper::buildWebView() {
+    pending_ = false;
+
+    if (pool_ && !lease_) {
+        lease_ = pool_->acquire();
+        webview_ = lease_.get();
+    }
+    if (!webview_) return false;
+
+    if (!webview_->create()) return false;
+
+    if (lazy_) {
+        // Keep the placeholder until clasp.js reports the page loaded; a
+        // pooled view may have loaded it already
+        waitingForPage_ = true;
+        webview_->bind("__clasp_loaded", [this](const std::string&) {
+            pageReady();
+            return std::string();
+        });
+        webview_->evaluateScript(
+            "if (window.clasp && clasp.isLoaded && clasp.isLoaded()) __clasp_loaded();");
+    }
+
+    if (onCreated_) {
+        onCreated_(*webview_);
+    }
+    return true;
+}
+
+void GuiHelper::removePlaceholder() {
+    if (placeholder_) {
+        platform::destroyPlaceholder(placeholder_);
+        placeholder_ = nullptr;
+    }
+}
+
+WebViewPool& GuiHelper::parkingPool() const {
+    return pool_ ? *pool_ : WebViewPool::shared();
+}
+
+void GuiHelper::releaseWebView(bool discard) {
+    if (webview_ && onDestroy_) {
+        onDestroy_(*webview_);
+    }
+
+    if (lease_) {
+        webview_ = nullptr;
+        if (pool_ && discard) {
+            pool_->discard(std::move(lease_));
+        } else if (pool_) {
+            pool_->release(std::move(lease_));
+        }
+        lease_.reset();
+    } else if (webview_) {
+        webview_->destroy();
+    }
+}
+
 bool GuiHelper::isApiSupported(const char* api, bool isFloating) const {
     // We don't support floating windows
     if (isFloating) return false;
@@ -41,16 +158,53 @@ bool GuiHelper::getPreferredApi(const char** api, bool* isFloating) const {
 
 bool GuiHelper::create(const char* api, bool isFloating) {
     if (!isApiSupported(api, isFloating)) return false;
-    if (!webview_) return false;
 
-    return webview_->create();
+    // Reuse the parked view; the page is still loaded
+    if (parked_) {
+        parkingPool().unpark(webview_);
+        parked_ = false;
+        if (onResumed_) {
+            onResumed_(*webview_);
+        }
+        return true;
+    }
+
+    // Lazy: return at once; the webview is built on first show() or idle()
+    if (lazy_) {
+        pending_ = true;
+        return true;
+    }
+
+    return buildWebView();
 }
 
 void GuiHelper::destroy() {
-    if (webview_) {
-        webview_->destroy();
-    }
     visible_ = false;
+    removePlaceholder();
+    parent_ = NativeWindow();
+    if (parked_) return;
+
+    bool loaded = !pending_ && !waitingForPage_;
+    pending_ = false;
+    waitingForPage_ = false;
+
+    if (!parkOnDestroy_ || !loaded || !webview_ || !webview_->isCreated()) {
+        releaseWebView();
+        return;
+    }
+
+    webview_->detach();
+    parked_ = true;
+    if (onParked_) {
+        onParked_(*webview_);
+    }
+
+    // May evict this view right away if the budget allows no parked views;
+    // an evicted view is destroyed, not returned to the idle list
+    parkingPool().park(webview_, [this] {
+        parked_ = false;
+        releaseWebView(true);
+    });
 }
 
 bool GuiHelper::setScale(double scale) {
@@ -90,7 +244,10 @@ bool GuiHelper::setSize(uint32_t width, uint32_t height) {
     width_ = width;
     height_ = height;
 
-    if (webview_) {
+    if (placeholder_) {
+        platform::resizeWebView(placeholder_, width, height);
+    }
+    if (webview_ && !waitingForPage_) {
         webview_->setSize(width, height);
     }
 
@@ -98,7 +255,7 @@ bool GuiHelper::setSize(uint32_t width, uint32_t height) {
 }
 
 bool GuiHelper::setParent(const clap_window_t* window) {
-    if (!webview_ || !window) return false;
+    if (!window) return false;
 
     NativeWindow native;
 
@@ -120,7 +277,16 @@ bool GuiHelper::setParent(const clap_window_t* window) {
 #endif
 
     if (!native.handle) return false;
+    parent_ = native;
+
+    // Lazy: fill the parent with a placeholder until the page has loaded
+    if (pending_ || waitingForPage_) {
+        removePlaceholder();
+        placeholder_ = platform::createPlaceholder(native.handle, width_, height_);
+        return true;
+    }
 
+    if (!webview_) return false;
     webview_->setParent(native);
     webview_->setSize(width_, height_);
 
@@ -138,6 +304,12 @@ void GuiHelper::suggestTitle(const char* title) {
 
 bool GuiHelper::show() {
     visible_ = true;
+    if (pending_ && !buildWebView()) {
+        return false;
+    }
+    if (waitingForPage_) {
+        return true;  // Shown by pageReady()
+    }
     if (webview_) {
         return webview_->show();
     }
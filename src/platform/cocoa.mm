@@ -5,9 +5,20 @@
 #import <WebKit/WebKit.h>
 #import <Carbon/Carbon.h> // For kVK_ANSI_I
 
+#include "clasp-gui/platform.h"
+
 namespace clasp_gui {
 namespace platform {
 
+void* getEmbeddableWindow(void* engineView) {
+    // The view is a native window already
+    return engineView;
+}
+
+void releaseEmbeddableWindow(void* window) {
+    (void)window;
+}
+
 bool embedWebView(void* parent, void* webview, int width, int height) {
     if (!parent || !webview) return false;
 
@@ -35,6 +46,14 @@ bool resizeWebView(void* webview, int width, int height) {
     return true;
 }
 
+void flushPendingResizes() {
+    // Resizes are applied immediately
+}
+
+bool coalescesResizes() {
+    return false;
+}
+
 bool removeWebView(void* webview) {
     if (!webview) return false;
 
@@ -44,6 +63,42 @@ bool removeWebView(void* webview) {
     return true;
 }
 
+void* createPlaceholder(void* parent, int width, int height) {
+    if (!parent) return nullptr;
+
+    NSView* parentView = (__bridge NSView*)parent;
+    NSView* view = [[NSView alloc] initWithFrame:NSMakeRect(0, 0, width, height)];
+    [view setWantsLayer:YES];
+    view.layer.backgroundColor = [[NSColor colorWithCalibratedWhite:0.12 alpha:1.0] CGColor];
+    [view setAutoresizingMask:NSViewWidthSizable | NSViewHeightSizable];
+    [parentView addSubview:view];
+
+    return (__bridge void*)view;
+}
+
+void destroyPlaceholder(void* placeholder) {
+    if (!placeholder) return;
+
+    NSView* view = (__bridge NSView*)placeholder;
+    [view removeFromSuperview];
+#if !__has_feature(objc_arc)
+    [view release];
+#endif
+}
+
+bool configureWebContext(const WebViewOptions& options) {
+    // WKWebView manages its web content processes itself
+    (void)options;
+    return false;
+}
+
+bool applyViewSettings(void* engineView, const WebViewOptions& options) {
+    // WKWebView has no public switches for WebGL, media or compositing
+    (void)engineView;
+    (void)options;
+    return false;
+}
+
 void initPlatformFixes(void* webview) {
     if (!webview) return;
 
@@ -1,28 +1,161 @@
 // Platform-specific WebView embedding for Linux (X11)
 #if !defined(__APPLE__) && !defined(_WIN32)
 
+#include "clasp-gui/platform.h"
+
+#include <chrono>
 #include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <X11/Xlib.h>
 #include <X11/keysym.h>
 #include <X11/extensions/XTest.h>
 
+#if __has_include(<webkit2/webkit2.h>)
+#include <webkit2/webkit2.h>
+#include <gdk/gdkx.h>
+#define CLASP_GUI_HAS_WEBKITGTK 1
+#else
+#define CLASP_GUI_HAS_WEBKITGTK 0
+#endif
+
 namespace clasp_gui {
 namespace platform {
 
+namespace {
+
+// One X connection per process, opened on first use and kept open (placeholders
+// belong to it). Xlib is only thread-safe after XInitThreads(), which a plugin
+// cannot call early enough, so every use holds DisplayLock.
+std::mutex& displayMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+class DisplayLock {
+public:
+    DisplayLock() : lock_(displayMutex()) {
+        static Display* display = nullptr;
+        if (!display) display = XOpenDisplay(NULL);  // Retried until it opens
+        display_ = display;
+    }
+
+    Display* get() const { return display_; }
+
+private:
+    std::lock_guard<std::mutex> lock_;
+    Display* display_;
+};
+
+// Resizes are coalesced: within a frame only the latest size per window is
+// applied (guarded by DisplayLock)
+constexpr auto kResizeFrame = std::chrono::milliseconds(16);
+
+struct ResizeState {
+    std::unordered_map<Window, std::pair<int, int>> pending;
+    std::chrono::steady_clock::time_point lastApplied;
+    bool flushScheduled = false;
+};
+
+ResizeState& resizeState() {
+    static ResizeState state;
+    return state;
+}
+
+void applyPendingResizes(Display* display) {
+    auto& state = resizeState();
+    for (const auto& resize : state.pending) {
+        XMoveResizeWindow(display, resize.first, 0, 0,
+                          resize.second.first, resize.second.second);
+    }
+    if (!state.pending.empty()) {
+        XFlush(display);
+        state.pending.clear();
+        state.lastApplied = std::chrono::steady_clock::now();
+    }
+}
+
+#if CLASP_GUI_HAS_WEBKITGTK
+// WebKitGTK needs the GLib main loop, so it is there to apply the frame's last size
+gboolean flushResizesSource(gpointer) {
+    DisplayLock lock;
+    resizeState().flushScheduled = false;
+    if (lock.get()) applyPendingResizes(lock.get());
+    return G_SOURCE_REMOVE;
+}
+#endif
+
+#if CLASP_GUI_HAS_WEBKITGTK
+// GTK toplevels made by getEmbeddableWindow(), by X window (main thread only)
+std::unordered_map<Window, GtkWidget*>& embeddingToplevels() {
+    static std::unordered_map<Window, GtkWidget*> toplevels;
+    return toplevels;
+}
+#endif
+
+} // namespace
+
+void* getEmbeddableWindow(void* engineView) {
+    if (!engineView) return nullptr;
+#if CLASP_GUI_HAS_WEBKITGTK
+    // CHOC's handle is the WebKitWebView widget; X can only reparent the
+    // window of a toplevel, so give the view one of its own
+    GtkWidget* view = GTK_WIDGET(engineView);
+    GtkWidget* toplevel = gtk_widget_get_toplevel(view);
+    bool created = false;
+    if (!gtk_widget_is_toplevel(toplevel)) {
+        toplevel = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+        gtk_window_set_decorated(GTK_WINDOW(toplevel), FALSE);
+        gtk_container_add(GTK_CONTAINER(toplevel), view);
+        created = true;
+    }
+    // Realized but left unmapped; embedWebView() maps it inside the host
+    gtk_widget_show(view);
+    gtk_widget_realize(toplevel);
+
+    GdkWindow* window = gtk_widget_get_window(toplevel);
+    if (!window || !GDK_IS_X11_WINDOW(window)) {
+        if (created) gtk_widget_destroy(toplevel);
+        return nullptr;  // Not running on X11
+    }
+    Window xid = gdk_x11_window_get_xid(window);
+    if (created) embeddingToplevels()[xid] = toplevel;
+    return reinterpret_cast<void*>(static_cast<uintptr_t>(xid));
+#else
+    // No GTK here: the handle can only be an X window already
+    return engineView;
+#endif
+}
+
+void releaseEmbeddableWindow(void* window) {
+#if CLASP_GUI_HAS_WEBKITGTK
+    auto& toplevels = embeddingToplevels();
+    auto it = toplevels.find((Window)(uintptr_t)window);
+    if (it == toplevels.end()) return;
+    // Also frees the view if the engine only dropped its reference
+    gtk_widget_destroy(it->second);
+    toplevels.erase(it);
+#else
+    (void)window;
+#endif
+}
+
 bool embedWebView(void* parent, void* webview, int width, int height) {
     if (!parent || !webview) return false;
 
-    Display* display = XOpenDisplay(NULL);
+    DisplayLock lock;
+    Display* display = lock.get();
     if (!display) return false;
 
     Window parentWindow = (Window)(uintptr_t)parent;
     Window webviewWindow = (Window)(uintptr_t)webview;
+    resizeState().pending.erase(webviewWindow);
 
     XReparentWindow(display, webviewWindow, parentWindow, 0, 0);
     XMapWindow(display, webviewWindow);
     XMoveResizeWindow(display, webviewWindow, 0, 0, width, height);
     XFlush(display);
-    XCloseDisplay(display);
 
     return true;
 }
@@ -30,29 +163,179 @@ bool embedWebView(void* parent, void* webview, int width, int height) {
 bool resizeWebView(void* webview, int width, int height) {
     if (!webview) return false;
 
-    Display* display = XOpenDisplay(NULL);
+    DisplayLock lock;
+    Display* display = lock.get();
     if (!display) return false;
 
-    Window webviewWindow = (Window)(uintptr_t)webview;
-    XMoveResizeWindow(display, webviewWindow, 0, 0, width, height);
-    XFlush(display);
-    XCloseDisplay(display);
+    auto& state = resizeState();
+    state.pending[(Window)(uintptr_t)webview] = {width, height};
 
+    // First resize in a frame goes out at once; later ones wait for the next frame
+    auto now = std::chrono::steady_clock::now();
+    if (!state.flushScheduled && now - state.lastApplied >= kResizeFrame) {
+        applyPendingResizes(display);
+        return true;
+    }
+
+#if CLASP_GUI_HAS_WEBKITGTK
+    if (!state.flushScheduled) {
+        state.flushScheduled = true;
+        g_timeout_add(static_cast<guint>(kResizeFrame.count()), flushResizesSource, nullptr);
+    }
+#else
+    // No main loop to wait for
+    applyPendingResizes(display);
+#endif
     return true;
 }
 
+void flushPendingResizes() {
+    DisplayLock lock;
+    if (lock.get()) applyPendingResizes(lock.get());
+}
+
+bool coalescesResizes() {
+    return CLASP_GUI_HAS_WEBKITGTK != 0;
+}
+
 bool removeWebView(void* webview) {
     if (!webview) return false;
 
-    Display* display = XOpenDisplay(NULL);
+    DisplayLock lock;
+    Display* display = lock.get();
     if (!display) return false;
 
     Window webviewWindow = (Window)(uintptr_t)webview;
+    resizeState().pending.erase(webviewWindow);
+
     XUnmapWindow(display, webviewWindow);
+    // Move to the root window so the view survives the host destroying its parent
+    XReparentWindow(display, webviewWindow, DefaultRootWindow(display), 0, 0);
+    XFlush(display);
+
+    return true;
+}
+
+void* createPlaceholder(void* parent, int width, int height) {
+    DisplayLock lock;
+    Display* display = lock.get();
+    if (!parent || !display) return nullptr;
+
+    Window parentWindow = (Window)(uintptr_t)parent;
+    Window window = XCreateSimpleWindow(display, parentWindow, 0, 0,
+                                        width > 0 ? width : 1, height > 0 ? height : 1,
+                                        0, 0, 0x1e1e1e);
+    XMapWindow(display, window);
     XFlush(display);
-    XCloseDisplay(display);
 
+    return reinterpret_cast<void*>(static_cast<uintptr_t>(window));
+}
+
+void destroyPlaceholder(void* placeholder) {
+    DisplayLock lock;
+    Display* display = lock.get();
+    if (!placeholder || !display) return;
+
+    Window window = (Window)(uintptr_t)placeholder;
+    resizeState().pending.erase(window);
+    XDestroyWindow(display, window);
+    XFlush(display);
+}
+
+bool configureWebContext(const WebViewOptions& options) {
+#if CLASP_GUI_HAS_WEBKITGTK
+    // Web processes inherit the environment, and JavaScriptCore reads its
+    // options from JSC_* variables once, at process start. So this must be set
+    // before the first context starts any process; later changes have no
+    // effect. A value set by the user wins.
+    if (options.jsHeapLimitMb > 0) {
+        std::string bytes = std::to_string(static_cast<unsigned long long>(options.jsHeapLimitMb) << 20);
+        g_setenv("JSC_gcMaxHeapSize", bytes.c_str(), FALSE);
+    }
+
+    // CHOC creates its views in the default context
+    WebKitWebContext* context = webkit_web_context_get_default();
+
+    // WebKitGTK 2.26+ ignores both and always runs one web process per view
+    // that was not created as a related view; 2.40 removed them. Check the
+    // running library, which may be newer than the headers.
+    bool applied = true;
+    if (options.shareWebProcess || options.webProcessLimit > 0) {
+#if !WEBKIT_CHECK_VERSION(2, 40, 0)
+        applied = webkit_get_major_version() == 2 && webkit_get_minor_version() < 26;
+        if (applied) {
+            G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+            if (options.shareWebProcess) {
+                webkit_web_context_set_process_model(context,
+                    WEBKIT_PROCESS_MODEL_SHARED_SECONDARY_PROCESS);
+            }
+            if (options.webProcessLimit > 0) {
+                webkit_web_context_set_web_process_count_limit(context,
+                    static_cast<guint>(options.webProcessLimit));
+            }
+            G_GNUC_END_IGNORE_DEPRECATIONS
+        }
+#else
+        applied = false;
+#endif
+        if (!applied) {
+            g_warning("clasp-gui: shareWebProcess and webProcessLimit have no effect "
+                      "with WebKitGTK %u.%u", webkit_get_major_version(),
+                      webkit_get_minor_version());
+        }
+    }
+
+    if (options.leanProfile) {
+        // Document viewer: no memory or disk cache for resources
+        webkit_web_context_set_cache_model(context, WEBKIT_CACHE_MODEL_DOCUMENT_VIEWER);
+        webkit_web_context_set_spell_checking_enabled(context, FALSE);
+    }
+    return applied;
+#else
+    (void)options;
+    return false;
+#endif
+}
+
+bool applyViewSettings(void* engineView, const WebViewOptions& options) {
+#if CLASP_GUI_HAS_WEBKITGTK
+    if (!engineView) return false;
+    WebKitWebView* view = static_cast<WebKitWebView*>(engineView);
+    WebKitSettings* settings = webkit_web_view_get_settings(view);
+
+    if (options.leanProfile) {
+        webkit_settings_set_enable_webgl(settings, FALSE);
+        webkit_settings_set_enable_webaudio(settings, FALSE);
+        webkit_settings_set_enable_media_stream(settings, FALSE);
+        webkit_settings_set_enable_mediasource(settings, FALSE);
+#if WEBKIT_CHECK_VERSION(2, 26, 0)
+        webkit_settings_set_enable_media(settings, FALSE);
+#endif
+        webkit_settings_set_enable_page_cache(settings, FALSE);
+        G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+        webkit_settings_set_enable_plugins(settings, FALSE);
+        webkit_settings_set_enable_java(settings, FALSE);
+        G_GNUC_END_IGNORE_DEPRECATIONS
+    }
+
+    switch (options.compositing) {
+    case CompositingPolicy::Always:
+        webkit_settings_set_hardware_acceleration_policy(settings,
+            WEBKIT_HARDWARE_ACCELERATION_POLICY_ALWAYS);
+        break;
+    case CompositingPolicy::Never:
+        webkit_settings_set_hardware_acceleration_policy(settings,
+            WEBKIT_HARDWARE_ACCELERATION_POLICY_NEVER);
+        break;
+    case CompositingPolicy::Default:
+        break;
+    }
     return true;
+#else
+    (void)engineView;
+    (void)options;
+    return false;
+#endif
 }
 
 void initPlatformFixes(void* webview) {
@@ -61,7 +344,8 @@ void initPlatformFixes(void* webview) {
 
 void simulateDevToolsShortcut() {
     // Simulate Ctrl+Shift+I to open dev tools (UNTESTED)
-    Display* display = XOpenDisplay(NULL);
+    DisplayLock lock;
+    Display* display = lock.get();
     if (!display) return;
 
     KeyCode keyI = XKeysymToKeycode(display, XK_i);
@@ -81,7 +365,6 @@ void simulateDevToolsShortcut() {
     XTestFakeKeyEvent(display, keyCtrl, False, 0);
 
     XFlush(display);
-    XCloseDisplay(display);
 }
 
 } // namespace platform
@@ -1,11 +1,23 @@
 // Platform-specific WebView embedding for Windows
 #if defined(_WIN32)
 
+#include "clasp-gui/platform.h"
+
+#include <string>
 #include <windows.h>
 
 namespace clasp_gui {
 namespace platform {
 
+void* getEmbeddableWindow(void* engineView) {
+    // The view is a native window already
+    return engineView;
+}
+
+void releaseEmbeddableWindow(void* window) {
+    (void)window;
+}
+
 bool embedWebView(void* parent, void* webview, int width, int height) {
     if (!parent || !webview) return false;
 
@@ -31,6 +43,14 @@ bool resizeWebView(void* webview, int width, int height) {
     return true;
 }
 
+void flushPendingResizes() {
+    // Resizes are applied immediately
+}
+
+bool coalescesResizes() {
+    return false;
+}
+
 bool removeWebView(void* webview) {
     if (!webview) return false;
 
@@ -40,6 +60,53 @@ bool removeWebView(void* webview) {
     return true;
 }
 
+void* createPlaceholder(void* parent, int width, int height) {
+    if (!parent) return nullptr;
+
+    HWND hwnd = CreateWindowExW(0, L"STATIC", L"", WS_CHILD | WS_VISIBLE,
+                                0, 0, width, height, (HWND)parent,
+                                NULL, GetModuleHandleW(NULL), NULL);
+    return hwnd;
+}
+
+void destroyPlaceholder(void* placeholder) {
+    if (placeholder) {
+        DestroyWindow((HWND)placeholder);
+    }
+}
+
+bool configureWebContext(const WebViewOptions& options) {
+    // WebView2 shares browser processes per user data folder, so only the
+    // browser arguments can be set, read when the first environment is created
+    std::string args;
+    if (options.leanProfile) {
+        args += " --disable-3d-apis --disk-cache-size=1"
+                " --autoplay-policy=user-gesture-required";
+    }
+    if (options.compositing == CompositingPolicy::Never) {
+        args += " --disable-gpu --disable-gpu-compositing";
+    } else if (options.compositing == CompositingPolicy::Always) {
+        args += " --ignore-gpu-blocklist";
+    }
+    if (options.jsHeapLimitMb > 0) {
+        args += " --js-flags=--max-old-space-size=" + std::to_string(options.jsHeapLimitMb);
+    }
+
+    // Arguments set by the user win
+    const char* variable = "WEBVIEW2_ADDITIONAL_BROWSER_ARGUMENTS";
+    if (args.empty() || GetEnvironmentVariableA(variable, nullptr, 0) > 0) {
+        return false;
+    }
+    return SetEnvironmentVariableA(variable, args.c_str() + 1) != 0;
+}
+
+bool applyViewSettings(void* engineView, const WebViewOptions& options) {
+    // Everything is set per process through configureWebContext()
+    (void)engineView;
+    (void)options;
+    return false;
+}
+
 void initPlatformFixes(void* webview) {
     // Windows keypress workaround will be initialized here
     // See fixes/keypress_win.cpp
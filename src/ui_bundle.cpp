@@ -0,0 +1,127 @@
+#include "clasp-gui/ui_bundle.h"
+
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#ifndef CLASP_GUI_HAS_ZLIB
+#define CLASP_GUI_HAS_ZLIB 0
+#endif
+
+#if CLASP_GUI_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+namespace clasp_gui {
+
+namespace {
+
+using Bytes = std::shared_ptr<const std::vector<uint8_t>>;
+
+// Inflated files, most recently used first; shared by all bundles
+class InflateCache {
+public:
+    static InflateCache& shared() {
+        static InflateCache cache;
+        return cache;
+    }
+
+    void setBudget(size_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        budget_ = bytes;
+        evictLocked();
+    }
+
+    Bytes get(const UiBundle::Entry* entry) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(entry);
+        if (it == index_.end()) return nullptr;
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return it->second->second;
+    }
+
+    void put(const UiBundle::Entry* entry, Bytes bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (index_.count(entry) || bytes->size() > budget_) return;
+        lru_.emplace_front(entry, bytes);
+        index_[entry] = lru_.begin();
+        used_ += bytes->size();
+        evictLocked();
+    }
+
+private:
+    void evictLocked() {
+        while (used_ > budget_ && !lru_.empty()) {
+            used_ -= lru_.back().second->size();
+            index_.erase(lru_.back().first);
+            lru_.pop_back();
+        }
+    }
+
+    using Item = std::pair<const UiBundle::Entry*, Bytes>;
+
+    std::mutex mutex_;
+    std::list<Item> lru_;
+    std::unordered_map<const UiBundle::Entry*, std::list<Item>::iterator> index_;
+    size_t used_ = 0;
+    size_t budget_ = 8u << 20;
+};
+
+} // namespace
+
+const UiBundle::Entry* UiBundle::find(const std::string& path) const {
+    auto it = std::lower_bound(entries_, entries_ + count_, path,
+        [](const Entry& e, const std::string& p) { return std::strcmp(e.path, p.c_str()) < 0; });
+    if (it == entries_ + count_ || path != it->path) return nullptr;
+    return it;
+}
+
+std::optional<WebResource> UiBundle::fetch(const std::string& path) const {
+    std::string file = path.substr(0, path.find_first_of("?#"));
+    const Entry* entry = find(file);
+    if (!entry) return std::nullopt;
+
+    WebResource resource;
+    resource.mimeType = WebView::mimeTypeForPath(file);
+    const uint8_t* stored = data_ + entry->offset;
+
+    if (!entry->compressed) {
+        resource.data.assign(stored, stored + entry->storedSize);
+        return resource;
+    }
+
+    auto& cache = InflateCache::shared();
+    Bytes bytes = cache.get(entry);
+    if (!bytes) {
+#if CLASP_GUI_HAS_ZLIB
+        auto inflated = std::make_shared<std::vector<uint8_t>>(entry->size);
+        uLongf length = entry->size;
+        if (uncompress(inflated->data(), &length, stored, entry->storedSize) != Z_OK
+            || length != entry->size) {
+            return std::nullopt;
+        }
+        bytes = inflated;
+        cache.put(entry, bytes);
+#else
+        return std::nullopt;  // Packed with zlib but built without it
+#endif
+    }
+
+    resource.data = *bytes;
+    return resource;
+}
+
+ResourceProvider UiBundle::provider() const {
+    const UiBundle* bundle = this;
+    return [bundle](const std::string& path) { return bundle->fetch(path); };
+}
+
+void UiBundle::setCacheBudget(size_t bytes) {
+    InflateCache::shared().setBudget(bytes);
+}
+
+} // namespace clasp_gui
@@ -1,6 +1,14 @@
 #include "clasp-gui/webview.h"
 #include "clasp-gui/platform.h"
 
+#include <cstdio>
+#include <unordered_map>
+#include <vector>
+
+// Generated from js/clasp.js by cmake/EmbedClaspJs.cmake
+extern const unsigned char clasp_gui_embedded_clasp_js[];
+extern const unsigned long clasp_gui_embedded_clasp_js_size;
+
 // CHOC WebView - optional dependency
 #if __has_include("choc/gui/choc_WebView.h")
 #include "choc/gui/choc_WebView.h"
@@ -19,15 +27,153 @@
 
 namespace clasp_gui {
 
+const std::string& WebView::getEmbeddedClaspJs() {
+    static const std::string js(reinterpret_cast<const char*>(clasp_gui_embedded_clasp_js),
+                                clasp_gui_embedded_clasp_js_size);
+    return js;
+}
+
+std::string WebView::getResourceRootUrl() const {
+#if defined(_WIN32)
+    return "https://" + options_.resourceScheme + ".localhost/";
+#else
+    return options_.resourceScheme + "://ui/";
+#endif
+}
+
+std::string WebView::mimeTypeForPath(const std::string& path) {
+    static const std::unordered_map<std::string, std::string> types = {
+        {"html", "text/html"},        {"htm", "text/html"},
+        {"js", "text/javascript"},    {"mjs", "text/javascript"},
+        {"css", "text/css"},          {"json", "application/json"},
+        {"svg", "image/svg+xml"},     {"png", "image/png"},
+        {"jpg", "image/jpeg"},        {"jpeg", "image/jpeg"},
+        {"gif", "image/gif"},         {"webp", "image/webp"},
+        {"ico", "image/x-icon"},      {"woff", "font/woff"},
+        {"woff2", "font/woff2"},      {"ttf", "font/ttf"},
+        {"otf", "font/otf"},          {"wasm", "application/wasm"},
+        {"txt", "text/plain"},
+    };
+
+    std::string file = path.substr(0, path.find_first_of("?#"));
+    auto dot = file.rfind('.');
+    auto slash = file.rfind('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return "application/octet-stream";
+    }
+
+    std::string ext = file.substr(dot + 1);
+    for (auto& c : ext) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    auto it = types.find(ext);
+    return it != types.end() ? it->second : "application/octet-stream";
+}
+
+void WebView::markStartup(StartupPhase phase) {
+    auto& time = startup_[static_cast<size_t>(phase)];
+    if (time == TimePoint{}) {
+        time = std::chrono::steady_clock::now();
+    }
+}
+
+std::optional<WebView::TimePoint> WebView::getStartupTime(StartupPhase phase) const {
+    auto time = startup_[static_cast<size_t>(phase)];
+    if (time == TimePoint{}) return std::nullopt;
+    return time;
+}
+
+double WebView::getStartupMs(StartupPhase phase) const {
+    auto start = getStartupTime(StartupPhase::Create);
+    auto time = getStartupTime(phase);
+    if (!start || !time) return -1.0;
+    return std::chrono::duration<double, std::milli>(*time - *start).count();
+}
+
+std::string WebView::getStartupTimelineJson() const {
+    std::string json = "{";
+    for (size_t i = 0; i < startup_.size(); ++i) {
+        double ms = getStartupMs(static_cast<StartupPhase>(i));
+        if (ms < 0) continue;
+        char value[32];
+        std::snprintf(value, sizeof(value), "%.3f", ms);
+        if (json.size() > 1) json += ',';
+        json += std::string("\"") + getStartupPhaseName(static_cast<StartupPhase>(i)) + "\":" + value;
+    }
+    return json + "}";
+}
+
+void WebView::resetStartupTimeline() {
+    startup_.fill(TimePoint{});
+}
+
+const char* WebView::getStartupPhaseName(StartupPhase phase) {
+    switch (phase) {
+        case StartupPhase::Create: return "create";
+        case StartupPhase::Created: return "created";
+        case StartupPhase::SetParent: return "setParent";
+        case StartupPhase::Embedded: return "embedded";
+        case StartupPhase::Navigate: return "navigate";
+        case StartupPhase::DomContentLoaded: return "domContentLoaded";
+        case StartupPhase::FirstFrame: return "firstFrame";
+        case StartupPhase::Ready: return "ready";
+        case StartupPhase::ReadyApplied: return "readyApplied";
+        case StartupPhase::Count: break;
+    }
+    return "";
+}
+
 #if CLASP_GUI_HAS_CHOC
 
 struct WebView::Impl {
     std::unique_ptr<choc::ui::WebView> webview;
     void* parentWindow = nullptr;
+    bool embedded = false;  // Reparented into parentWindow by setSize()
     bool created = false;
     bool devToolsOpened = false;
+
+    // Bindings outlive the native view, so they can be made before create()
+    // and replaced when a pooled view changes owner
+    std::unordered_map<std::string, BindingCallback> bindings;
+
+    // Init scripts, likewise kept across create()/destroy()
+    std::vector<std::string> initScripts;
+    bool claspJsInjected = false;
+
+    void bindNative(const std::string& name);
+
+    // What the platform embedding functions take (an X window on Linux,
+    // where CHOC's handle is the WebKitWebView widget); made on first use
+    void* window = nullptr;
+    void* nativeWindow() {
+        if (!window) window = platform::getEmbeddableWindow(webview->getViewHandle());
+        return window;
+    }
 };
 
+void WebView::Impl::bindNative(const std::string& name) {
+#if CLASP_GUI_HAS_CHOC_VALUE
+    webview->bind(name,
+        [this, name](const choc::value::ValueView& args) -> choc::value::Value {
+            auto it = bindings.find(name);
+            if (it == bindings.end() || !it->second) {
+                return {};
+            }
+            std::string result = it->second(choc::json::toString(args));
+            if (result.empty()) {
+                return {};
+            }
+            try {
+                return choc::json::parse(result);
+            } catch (...) {
+                return choc::value::createString(result);
+            }
+        });
+#else
+    (void)name;
+#endif
+}
+
 WebView::WebView(const WebViewOptions& options)
     : impl_(std::make_unique<Impl>()), options_(options) {
 }
@@ -62,13 +208,47 @@ WindowApi WebView::getPreferredApi() {
 
 bool WebView::create() {
     if (impl_->created) return true;
+    markStartup(StartupPhase::Create);
+
+    // Process-wide web context settings only apply before the first web
+    // process starts, and only if the first view opted in
+    static bool contextConfigured = false;
+    if (!contextConfigured) {
+        contextConfigured = true;
+        if (options_.processWideSettings) {
+            platform::configureWebContext(options_);
+        }
+    }
 
     choc::ui::WebView::Options opts;
     opts.enableDebugMode = options_.enableDebugMode;
 
+    // Serve the custom scheme from the resource provider (no file I/O)
+    if (options_.resourceProvider) {
+        auto provider = options_.resourceProvider;
+        opts.customSchemeURI = getResourceRootUrl();
+        opts.fetchResource = [provider](const std::string& path)
+            -> std::optional<choc::ui::WebView::Options::Resource> {
+            std::string request = path.empty() || path == "/" ? "/index.html" : path;
+            auto resource = provider(request);
+            if (!resource) return {};
+
+            choc::ui::WebView::Options::Resource result;
+            result.data = std::move(resource->data);
+            result.mimeType = resource->mimeType.empty() ? WebView::mimeTypeForPath(request)
+                                                         : std::move(resource->mimeType);
+            return result;
+        };
+    }
+
     impl_->webview = std::make_unique<choc::ui::WebView>(opts);
     if (!impl_->webview) return false;
 
+    if (options_.leanProfile || options_.compositing != CompositingPolicy::Default) {
+        // Engine settings take the engine view itself, not its window
+        platform::applyViewSettings(impl_->webview->getViewHandle(), options_);
+    }
+
     // Inject context menu disabling script if requested
     if (options_.disableContextMenu) {
         impl_->webview->addInitScript(
@@ -81,20 +261,41 @@ bool WebView::create() {
         impl_->webview->addInitScript(options_.initScript);
     }
 
+    for (const auto& binding : impl_->bindings) {
+        impl_->bindNative(binding.first);
+    }
+
+    for (const auto& script : impl_->initScripts) {
+        impl_->webview->addInitScript(script);
+    }
+
     impl_->created = true;
+    markStartup(StartupPhase::Created);
     return true;
 }
 
 void WebView::destroy() {
     if (impl_->webview) {
-        auto handle = impl_->webview->getViewHandle();
-        platform::removeWebView(handle);
+        void* window = impl_->window;
+        if (window) platform::removeWebView(window);
         impl_->webview.reset();
+        platform::releaseEmbeddableWindow(window);
+        impl_->window = nullptr;
     }
     impl_->parentWindow = nullptr;
+    impl_->embedded = false;
     impl_->created = false;
 }
 
+bool WebView::detach() {
+    if (!impl_->webview) return false;
+
+    if (impl_->window) platform::removeWebView(impl_->window);
+    impl_->parentWindow = nullptr;
+    impl_->embedded = false;
+    return true;
+}
+
 bool WebView::isCreated() const {
     return impl_->created;
 }
@@ -102,22 +303,25 @@ bool WebView::isCreated() const {
 bool WebView::setParent(const NativeWindow& parent) {
     if (!impl_->webview || !parent.handle) return false;
 
+    if (parent.handle != impl_->parentWindow) impl_->embedded = false;
     impl_->parentWindow = parent.handle;
+    markStartup(StartupPhase::SetParent);
     return true;
 }
 
 bool WebView::setSize(uint32_t width, uint32_t height) {
     if (!impl_->webview) return false;
 
-    auto handle = impl_->webview->getViewHandle();
+    auto handle = impl_->nativeWindow();
 
-    if (impl_->parentWindow) {
-        platform::embedWebView(impl_->parentWindow, handle, width, height);
-    } else {
-        platform::resizeWebView(handle, width, height);
+    // Embed on the first size after setParent(); later sizes (a host drag)
+    // go through resizeWebView(), which coalesces them per frame
+    if (impl_->parentWindow && !impl_->embedded) {
+        impl_->embedded = platform::embedWebView(impl_->parentWindow, handle, width, height);
+        if (impl_->embedded) markStartup(StartupPhase::Embedded);
+        return impl_->embedded;
     }
-
-    return true;
+    return platform::resizeWebView(handle, width, height);
 }
 
 bool WebView::show() {
@@ -143,12 +347,14 @@ void* WebView::getNativeHandle() const {
 
 void WebView::navigate(const std::string& url) {
     if (impl_->webview) {
+        markStartup(StartupPhase::Navigate);
         impl_->webview->navigate(url);
     }
 }
 
 void WebView::loadHtml(const std::string& html) {
     if (impl_->webview) {
+        markStartup(StartupPhase::Navigate);
         impl_->webview->setHTML(html);
     }
 }
@@ -159,23 +365,40 @@ void WebView::evaluateScript(const std::string& js) {
     }
 }
 
+void WebView::addInitScript(const std::string& js) {
+    impl_->initScripts.push_back(js);
+    if (impl_->webview) {
+        impl_->webview->addInitScript(js);
+    }
+}
+
+void WebView::injectClaspJs() {
+    if (impl_->claspJsInjected) return;
+    impl_->claspJsInjected = true;
+    addInitScript(getEmbeddedClaspJs());
+}
+
 void WebView::bind(const std::string& name, BindingCallback callback) {
-    if (!impl_->webview) return;
+    bool isNew = impl_->bindings.find(name) == impl_->bindings.end();
+    impl_->bindings[name] = std::move(callback);
 
-#if CLASP_GUI_HAS_CHOC_VALUE
-    impl_->webview->bind(name,
-        [callback](const choc::value::ValueView& args) -> choc::value::Value {
-            std::string result = callback(choc::json::toString(args));
-            if (result.empty()) {
-                return {};
-            }
-            try {
-                return choc::json::parse(result);
-            } catch (...) {
-                return choc::value::createString(result);
-            }
-        });
-#endif
+    // Replacing a callback needs no new native binding
+    if (isNew && impl_->webview) {
+        impl_->bindNative(name);
+    }
+}
+
+void WebView::clearBindings() {
+    // Native bindings stay registered but now return null
+    for (auto& binding : impl_->bindings) {
+        binding.second = nullptr;
+    }
+}
+
+std::string WebView::invokeBinding(const std::string& name, const std::string& argsJson) {
+    auto it = impl_->bindings.find(name);
+    if (it == impl_->bindings.end() || !it->second) return {};
+    return it->second(argsJson);
 }
 
 void WebView::openDevTools() {
@@ -188,6 +411,9 @@ void WebView::openDevTools() {
 struct WebView::Impl {
     void* parentWindow = nullptr;
     bool created = false;
+
+    // Kept so invokeBinding() works without a native view
+    std::unordered_map<std::string, BindingCallback> bindings;
 };
 
 WebView::WebView(const WebViewOptions& options)
@@ -200,6 +426,7 @@ bool WebView::isApiSupported(WindowApi) { return false; }
 WindowApi WebView::getPreferredApi() { return WindowApi::Unknown; }
 bool WebView::create() { return false; }
 void WebView::destroy() {}
+bool WebView::detach() { return false; }
 bool WebView::isCreated() const { return false; }
 bool WebView::setParent(const NativeWindow&) { return false; }
 bool WebView::setSize(uint32_t, uint32_t) { return false; }
@@ -209,7 +436,19 @@ void* WebView::getNativeHandle() const { return nullptr; }
 void WebView::navigate(const std::string&) {}
 void WebView::loadHtml(const std::string&) {}
 void WebView::evaluateScript(const std::string&) {}
-void WebView::bind(const std::string&, BindingCallback) {}
+void WebView::addInitScript(const std::string&) {}
+void WebView::injectClaspJs() {}
+void WebView::bind(const std::string& name, BindingCallback callback) {
+    impl_->bindings[name] = std::move(callback);
+}
+void WebView::clearBindings() {
+    for (auto& binding : impl_->bindings) binding.second = nullptr;
+}
+std::string WebView::invokeBinding(const std::string& name, const std::string& argsJson) {
+    auto it = impl_->bindings.find(name);
+    if (it == impl_->bindings.end() || !it->second) return {};
+    return it->second(argsJson);
+}
 void WebView::openDevTools() {}
 
 #endif // CLASP_GUI_HAS_CHOC
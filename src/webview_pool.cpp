@@ -0,0 +1,194 @@
+#include "clasp-gui/webview_pool.h"
+
+#include <algorithm>
+
+namespace clasp_gui {
+
+WebViewPool::~WebViewPool() {
+    clear();
+}
+
+WebViewPool& WebViewPool::shared() {
+    static WebViewPool pool;
+    return pool;
+}
+
+static bool sameWebViewOptions(const WebViewOptions& a, const WebViewOptions& b) {
+    // Providers cannot be compared, so views serving one are always replaced
+    if (a.resourceProvider || b.resourceProvider) return false;
+
+    return a.enableDebugMode == b.enableDebugMode
+        && a.openDevToolsOnStart == b.openDevToolsOnStart
+        && a.disableContextMenu == b.disableContextMenu
+        && a.initScript == b.initScript
+        && a.shareWebProcess == b.shareWebProcess
+        && a.webProcessLimit == b.webProcessLimit
+        && a.leanProfile == b.leanProfile
+        && a.compositing == b.compositing
+        && a.jsHeapLimitMb == b.jsHeapLimitMb
+        && a.resourceScheme == b.resourceScheme;
+}
+
+void WebViewPool::configure(const WebViewPoolOptions& options) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool stale = options.url != options_.url
+        || !sameWebViewOptions(options.webViewOptions, options_.webViewOptions);
+    options_ = options;
+
+    if (stale) {
+        idle_.clear();
+    } else if (idle_.size() > options_.size) {
+        // Keep the most recently returned views
+        idle_.erase(idle_.begin(), idle_.end() - options_.size);
+    }
+    stats_.idle = idle_.size();
+}
+
+WebViewPoolOptions WebViewPool::getOptions() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return options_;
+}
+
+void WebViewPool::warm() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    trimLocked(std::chrono::steady_clock::now());
+
+    while (idle_.size() < options_.size) {
+        auto view = createView();
+        if (!view) break;
+        idle_.push_back({std::move(view), std::chrono::steady_clock::now()});
+    }
+    stats_.idle = idle_.size();
+}
+
+std::unique_ptr<WebView> WebViewPool::acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    trimLocked(std::chrono::steady_clock::now());
+
+    std::unique_ptr<WebView> view;
+    if (!idle_.empty()) {
+        view = std::move(idle_.back().view);
+        idle_.pop_back();
+        ++stats_.hits;
+    } else {
+        view = createView();
+        ++stats_.misses;
+        if (!view) return nullptr;
+    }
+
+    // The new owner's startup begins now; a warm page reports no load phases
+    view->resetStartupTimeline();
+    view->markStartup(StartupPhase::Create);
+
+    ++stats_.leased;
+    stats_.idle = idle_.size();
+    return view;
+}
+
+void WebViewPool::release(std::unique_ptr<WebView> view) {
+    if (!view) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stats_.leased > 0) --stats_.leased;
+    auto now = std::chrono::steady_clock::now();
+    trimLocked(now);
+
+    if (idle_.size() >= options_.size || !view->isCreated()) {
+        return;  // view destroyed here
+    }
+
+    // Reset for the next owner: the previous owner's callbacks and page
+    // state must not leak into another plugin instance
+    view->detach();
+    view->clearBindings();
+    if (!options_.url.empty()) {
+        view->navigate(options_.url);
+    }
+
+    idle_.push_back({std::move(view), now});
+    stats_.idle = idle_.size();
+}
+
+void WebViewPool::discard(std::unique_ptr<WebView> view) {
+    if (!view) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stats_.leased > 0) --stats_.leased;
+    }
+    view.reset();  // Outside the lock: destroying a view can take a while
+}
+
+void WebViewPool::park(WebView* view, EvictCallback evict) {
+    if (!view) return;
+
+    std::vector<EvictCallback> evictions;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto same = [view](const ParkedEntry& e) { return e.view == view; };
+        parked_.erase(std::remove_if(parked_.begin(), parked_.end(), same), parked_.end());
+        parked_.push_back({view, std::move(evict)});
+
+        size_t estimate = std::max<size_t>(options_.viewMemoryEstimate, 1);
+        size_t maxParked = options_.parkBudget / estimate;
+        while (parked_.size() > maxParked) {
+            evictions.push_back(std::move(parked_.front().evict));
+            parked_.erase(parked_.begin());
+            ++stats_.evicted;
+        }
+        stats_.parked = parked_.size();
+    }
+
+    // Outside the lock: owners typically release() the evicted view
+    for (auto& e : evictions) {
+        if (e) e();
+    }
+}
+
+void WebViewPool::unpark(WebView* view) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto same = [view](const ParkedEntry& e) { return e.view == view; };
+    parked_.erase(std::remove_if(parked_.begin(), parked_.end(), same), parked_.end());
+    stats_.parked = parked_.size();
+}
+
+void WebViewPool::trim() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    trimLocked(std::chrono::steady_clock::now());
+}
+
+void WebViewPool::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    idle_.clear();
+    stats_.idle = 0;
+}
+
+WebViewPoolStats WebViewPool::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+std::unique_ptr<WebView> WebViewPool::createView() {
+    auto view = std::make_unique<WebView>(options_.webViewOptions);
+    if (!view->create()) return nullptr;
+
+    // The page loads before any Protocol attaches, so inject the bridge now
+    view->injectClaspJs();
+    if (!options_.url.empty()) {
+        view->navigate(options_.url);
+    }
+    ++stats_.created;
+    return view;
+}
+
+void WebViewPool::trimLocked(std::chrono::steady_clock::time_point now) {
+    if (options_.idleTimeout.count() <= 0) return;
+
+    auto expired = [&](const Entry& e) { return now - e.idleSince >= options_.idleTimeout; };
+    auto it = std::remove_if(idle_.begin(), idle_.end(), expired);
+    stats_.expired += static_cast<uint64_t>(idle_.end() - it);
+    idle_.erase(it, idle_.end());
+    stats_.idle = idle_.size();
+}
+
+} // namespace clasp_gui
@@ -0,0 +1,109 @@
+// protocol_test.cpp - clasp::Protocol message dispatch
+
+#include <clasp-gui/clasp.hpp>
+#include <clasp-gui/webview.h>
+
+#include "test.h"
+
+#include <string>
+
+namespace {
+
+// A message as clasp.js passes it to the __clasp binding: ["<escaped JSON>"]
+std::string fromJs(const std::string& json) {
+    std::string escaped;
+    for (char c : json) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return "[\"" + escaped + "\"]";
+}
+
+void handlersMayUseProtocol() {
+    clasp_gui::WebView view;
+    clasp::Protocol proto(&view);
+
+    bool saved = false;
+    proto.onCall("getPresets", [](const std::string&) { return "[]"; }, {true, {"presets"}});
+    proto.onCall("savePreset", [&](const std::string&) {
+        saved = true;
+        proto.invalidateCacheTag("presets");
+        proto.sendReady();
+        proto.onCall("later", [](const std::string&) { return "1"; });
+        return "true";
+    });
+    proto.onMessage("reset", [&](const std::string&) { proto.invalidateCacheTag("presets"); });
+    proto.onMessageBatch("meter", [&](const std::vector<std::string>&) {
+        proto.invalidateCache("getPresets");
+    });
+
+    view.invokeBinding("__clasp", fromJs(R"({"t":"call","fn":"savePreset","args":[],"id":1})"));
+    CHECK(saved);
+
+    view.invokeBinding("__clasp", fromJs(R"({"t":"msg","type":"reset","payload":{}})"));
+    view.invokeBinding("__clasp",
+        fromJs(R"([{"t":"msg","type":"meter","payload":1},{"t":"call","fn":"savePreset","args":[],"id":2}])"));
+}
+
+void handshakeSetsVersion() {
+    clasp_gui::WebView view;
+    clasp::Protocol proto(&view);
+    CHECK(!proto.isProtocolVersionMatch());
+
+    // clasp.js answers the hello request sent on attach the same way
+    view.invokeBinding("__clasp", fromJs(R"({"t":"hello","v":1})"));
+    CHECK(proto.getJsProtocolVersion() == 1);
+    CHECK(proto.isProtocolVersionMatch());
+}
+
+void gesturesUseRegisteredIds() {
+    clasp_gui::WebView view;
+    clasp::Protocol proto(&view);
+    proto.setParamIds({7, 3000000000u, 1000});
+
+    view.invokeBinding("__clasp", fromJs(R"({"t":"gesture","id":3000000000,"on":true})"));
+    CHECK(proto.isGestureActive(3000000000u));
+    CHECK(!proto.isGestureActive(7));
+
+    clasp::ParamChange change;
+    CHECK(proto.popParamChange(change));
+    CHECK(change.type == clasp::ParamChange::Type::GestureBegin);
+    CHECK(change.id == 3000000000u);
+
+    view.invokeBinding("__clasp", fromJs(R"({"t":"gesture","id":3000000000,"on":false})"));
+    CHECK(!proto.isGestureActive(3000000000u));
+    CHECK(proto.popParamChange(change));
+    CHECK(change.type == clasp::ParamChange::Type::GestureEnd);
+
+    // Unregistered ids are not tracked, but still reach the audio thread
+    view.invokeBinding("__clasp", fromJs(R"({"t":"gesture","id":5,"on":true})"));
+    CHECK(!proto.isGestureActive(5));
+    CHECK(proto.popParamChange(change));
+    CHECK(change.id == 5);
+}
+
+void invalidParamIdsAreRejected() {
+    clasp_gui::WebView view;
+    clasp::Protocol proto(&view);
+
+    view.invokeBinding("__clasp", fromJs(R"({"t":"gesture","on":true})"));
+    view.invokeBinding("__clasp", fromJs(R"({"t":"gesture","id":-1,"on":true})"));
+    view.invokeBinding("__clasp", fromJs(R"({"t":"gesture","id":4294967296,"on":true})"));
+    view.invokeBinding("__clasp", fromJs(R"({"t":"set","p":[-1,0.5,1.5,0.5,4294967295,0.25]})"));
+
+    clasp::ParamChange change;
+    CHECK(proto.popParamChange(change));
+    CHECK(change.type == clasp::ParamChange::Type::Value);
+    CHECK(change.id == 4294967295u);
+    CHECK(!proto.popParamChange(change));
+}
+
+} // namespace
+
+int main() {
+    runWithTimeout("handlers may use the protocol", handlersMayUseProtocol);
+    runWithTimeout("handshake sets version", handshakeSetsVersion);
+    runWithTimeout("gestures use registered ids", gesturesUseRegisteredIds);
+    runWithTimeout("invalid param ids are rejected", invalidParamIdsAreRejected);
+    return 0;
+}
@@ -0,0 +1,32 @@
+// test.h - Minimal assertions for the headless tests
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <thread>
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            std::exit(1);                                                        \
+        }                                                                        \
+    } while (0)
+
+// Run fn on a thread and fail the test if it does not finish in time
+// (a deadlock would otherwise hang ctest)
+inline void runWithTimeout(const char* name, std::function<void()> fn,
+                           std::chrono::seconds timeout = std::chrono::seconds(5)) {
+    std::packaged_task<void()> task(std::move(fn));
+    auto done = task.get_future();
+    std::thread(std::move(task)).detach();
+    if (done.wait_for(timeout) != std::future_status::ready) {
+        std::fprintf(stderr, "%s: timed out (deadlock?)\n", name);
+        std::_Exit(1);
+    }
+    done.get();
+    std::printf("ok %s\n", name);
+}
@@ -0,0 +1,70 @@
+// webview_pool_test.cpp - clasp_gui::WebViewPool parking budget
+
+#include <clasp-gui/webview_pool.h>
+
+#include "test.h"
+
+#include <memory>
+#include <vector>
+
+namespace {
+
+void parkedViewsStayWithinBudget() {
+    clasp_gui::WebViewPool pool;
+    clasp_gui::WebViewPoolOptions options;
+    options.viewMemoryEstimate = 100;
+    options.parkBudget = 350;  // Room for 3 views
+    pool.configure(options);
+    const size_t maxResident = options.parkBudget / options.viewMemoryEstimate;
+
+    // Owners keep their views alive while parked, as GuiHelper does
+    std::vector<std::unique_ptr<clasp_gui::WebView>> owners;
+    for (int i = 0; i < 10; ++i) {
+        owners.push_back(std::make_unique<clasp_gui::WebView>());
+        pool.park(owners.back().get(), [&pool, &owners, i] {
+            pool.discard(std::move(owners[i]));
+        });
+
+        size_t resident = 0;
+        for (const auto& view : owners) resident += view ? 1 : 0;
+        auto stats = pool.getStats();
+        CHECK(resident <= maxResident);
+        CHECK(stats.parked <= maxResident);
+        CHECK(stats.idle == 0);  // Evicted views are destroyed, not pooled
+    }
+
+    auto stats = pool.getStats();
+    CHECK(stats.parked == maxResident);
+    CHECK(stats.evicted == 10 - maxResident);
+
+    // The oldest views went first
+    for (int i = 0; i < 10; ++i) {
+        CHECK((owners[i] != nullptr) == (i >= 10 - static_cast<int>(maxResident)));
+    }
+
+    for (const auto& view : owners) {
+        if (view) pool.unpark(view.get());
+    }
+    CHECK(pool.getStats().parked == 0);
+}
+
+void zeroBudgetEvictsAtOnce() {
+    clasp_gui::WebViewPool pool;
+    clasp_gui::WebViewPoolOptions options;
+    options.parkBudget = 0;
+    pool.configure(options);
+
+    auto view = std::make_unique<clasp_gui::WebView>();
+    pool.park(view.get(), [&] { pool.discard(std::move(view)); });
+    CHECK(view == nullptr);
+    CHECK(pool.getStats().parked == 0);
+    CHECK(pool.getStats().idle == 0);
+}
+
+} // namespace
+
+int main() {
+    runWithTimeout("parked views stay within budget", parkedViewsStayWithinBudget);
+    runWithTimeout("zero budget evicts at once", zeroBudgetEvictsAtOnce);
+    return 0;
+}
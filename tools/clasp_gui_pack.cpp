@@ -0,0 +1,149 @@
+// clasp_gui_pack.cpp - Packs a web UI directory into a C++ source file
+//
+// Usage: clasp-gui-pack <name> <dir> <out.cpp> <out.h>
+// Run by clasp_gui_add_ui_bundle(); generates `const clasp_gui::UiBundle& <name>()`.
+//
+// Files are sorted by path, deflated when that saves at least 1/8 (and zlib
+// is available), and hashed (FNV-1a 64) for ETags.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#ifndef CLASP_GUI_HAS_ZLIB
+#define CLASP_GUI_HAS_ZLIB 0
+#endif
+
+#if CLASP_GUI_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct File {
+    std::string path;
+    std::vector<uint8_t> stored;
+    uint32_t size = 0;
+    bool compressed = false;
+    uint64_t hash = 0;
+};
+
+uint64_t fnv1a(const std::vector<uint8_t>& bytes) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (uint8_t b : bytes) {
+        h ^= b;
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+void deflateIfSmaller(File& file, std::vector<uint8_t> content) {
+#if CLASP_GUI_HAS_ZLIB
+    uLongf length = compressBound(static_cast<uLong>(content.size()));
+    std::vector<uint8_t> packed(length);
+    if (compress2(packed.data(), &length, content.data(),
+                  static_cast<uLong>(content.size()), Z_BEST_COMPRESSION) == Z_OK
+        && length < content.size() - content.size() / 8) {
+        packed.resize(length);
+        file.stored = std::move(packed);
+        file.compressed = true;
+        return;
+    }
+#endif
+    file.stored = std::move(content);
+}
+
+bool isHidden(const fs::path& relative) {
+    for (const auto& part : relative) {
+        if (!part.empty() && part.string()[0] == '.') return true;
+    }
+    return false;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc != 5) {
+        std::fprintf(stderr, "usage: clasp-gui-pack <name> <dir> <out.cpp> <out.h>\n");
+        return 1;
+    }
+    std::string name = argv[1];
+    fs::path root = argv[2];
+
+    std::vector<File> files;
+    for (const auto& item : fs::recursive_directory_iterator(root)) {
+        if (!item.is_regular_file()) continue;
+        fs::path relative = fs::relative(item.path(), root);
+        if (isHidden(relative)) continue;
+
+        std::ifstream in(item.path(), std::ios::binary);
+        std::vector<uint8_t> content((std::istreambuf_iterator<char>(in)),
+                                     std::istreambuf_iterator<char>());
+        File file;
+        file.path = "/" + relative.generic_string();
+        file.size = static_cast<uint32_t>(content.size());
+        file.hash = fnv1a(content);
+        deflateIfSmaller(file, std::move(content));
+        files.push_back(std::move(file));
+    }
+
+    // UiBundle::find() binary-searches with strcmp
+    std::sort(files.begin(), files.end(),
+              [](const File& a, const File& b) { return a.path < b.path; });
+
+    std::ofstream cpp(argv[3], std::ios::binary);
+    cpp << "// Generated by clasp-gui-pack from " << root.generic_string() << " - do not edit\n"
+        << "#include \"" << name << ".h\"\n\n"
+        << "namespace {\n\n"
+        << "alignas(8) const uint8_t data[] = {\n";
+
+    uint32_t offset = 0;
+    size_t column = 0;
+    for (const auto& f : files) {
+        for (uint8_t b : f.stored) {
+            cpp << static_cast<unsigned>(b) << ',';
+            if (++column % 32 == 0) cpp << '\n';
+        }
+    }
+    if (column == 0) cpp << "0";
+    cpp << "\n};\n\n"
+        << "const clasp_gui::UiBundle::Entry entries[] = {\n";
+
+    for (const auto& f : files) {
+        char etag[24];
+        std::snprintf(etag, sizeof(etag), "%016llx", static_cast<unsigned long long>(f.hash));
+        std::string path;
+        for (char c : f.path) {
+            if (c == '"' || c == '\\') path += '\\';
+            path += c;
+        }
+        cpp << "    {\"" << path << "\", " << offset << ", " << f.stored.size() << ", "
+            << f.size << ", " << (f.compressed ? "true" : "false")
+            << ", \"\\\"" << etag << "\\\"\"},\n";
+        offset += static_cast<uint32_t>(f.stored.size());
+    }
+    if (files.empty()) cpp << "    {\"\", 0, 0, 0, false, \"\"},\n";
+
+    cpp << "};\n\n"
+        << "} // namespace\n\n"
+        << "const clasp_gui::UiBundle& " << name << "() {\n"
+        << "    static const clasp_gui::UiBundle bundle(entries, " << files.size() << ", data);\n"
+        << "    return bundle;\n"
+        << "}\n";
+
+    std::ofstream h(argv[4], std::ios::binary);
+    h << "// Generated by clasp-gui-pack - do not edit\n"
+      << "#pragma once\n\n"
+      << "#include <clasp-gui/ui_bundle.h>\n\n"
+      << "// Web UI packed from " << root.generic_string() << "\n"
+      << "const clasp_gui::UiBundle& " << name << "();\n";
+
+    return cpp && h ? 0 : 1;
+}